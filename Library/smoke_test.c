@@ -0,0 +1,195 @@
+/*
+    Smoke test of libtrombone through its C interface only: creates an engine
+    with the default parameters, plays a second, checks that the mouth pressure
+    changes the sound, that snapshots restore bit-exactly and that invalid
+    parameters are rejected.
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "TromboneCApi.h"
+
+#define FS 44100.0
+#define BLOCK_SIZE 256
+
+static int failures = 0;
+
+static void check (int condition, const char* message)
+{
+    if (!condition)
+    {
+        printf ("FAILED: %s\n", message);
+        ++failures;
+    }
+}
+
+/* returns the peak of the block, or -1 if it contains NaN or inf */
+static double process (trombone_engine* engine, float* output, int numSamples)
+{
+    double peak = 0;
+    int n;
+    trombone_process (engine, output, numSamples);
+    for (n = 0; n < numSamples; ++n)
+    {
+        if (!isfinite (output[n]))
+            return -1;
+        if (fabs (output[n]) > peak)
+            peak = fabs (output[n]);
+    }
+    return peak;
+}
+
+/* rms of the second half of a second played at pressure, -1 if the engine can't be created */
+static double playRms (const trombone_params* params, double pressure)
+{
+    trombone_engine* engine = trombone_create (params, FS, NULL, 0);
+    float output[BLOCK_SIZE];
+    int numBlocks = (int) (0.5 * FS / BLOCK_SIZE);
+    double sum = 0;
+    int i, n;
+
+    if (engine == NULL)
+        return -1;
+
+    trombone_set_pressure (engine, pressure);
+    for (i = 0; i < 2 * numBlocks; ++i)
+    {
+        trombone_process (engine, output, BLOCK_SIZE);
+        if (i >= numBlocks)
+            for (n = 0; n < BLOCK_SIZE; ++n)
+                sum += output[n] * output[n];
+    }
+    trombone_destroy (engine);
+    return sqrt (sum / (numBlocks * BLOCK_SIZE));
+}
+
+int main (void)
+{
+    trombone_params params;
+    trombone_stats stats;
+    trombone_engine* engine;
+    char error[256] = { 0 };
+    float output[BLOCK_SIZE], expected[BLOCK_SIZE];
+    double* state;
+    size_t stateSize, written = 0;
+    double peak = 0;
+    int i;
+
+    check (trombone_get_api_version() == TROMBONE_API_VERSION, "api version");
+
+    trombone_default_params (&params);
+    engine = trombone_create (&params, FS, error, sizeof (error));
+    if (engine == NULL)
+    {
+        printf ("FAILED: could not create engine: %s\n", error);
+        return 1;
+    }
+
+    /* one second of sound */
+    trombone_set_pressure (engine, 300);
+    for (i = 0; i < (int) (FS / BLOCK_SIZE); ++i)
+    {
+        double blockPeak = process (engine, output, BLOCK_SIZE);
+        check (blockPeak >= 0, "output is finite");
+        if (blockPeak > peak)
+            peak = blockPeak;
+    }
+    check (peak > 0, "output is nonzero");
+
+    /* the mouth pressure drives the sound (only if the lips are connected) */
+    {
+        double quiet = playRms (&params, 200);
+        double loud = playRms (&params, 600);
+        check (quiet > 0 && loud > quiet, "a higher pressure plays louder");
+
+        params.connected_to_lip = 0;
+        quiet = playRms (&params, 200);
+        loud = playRms (&params, 600);
+        check (quiet >= 0 && loud == quiet, "the pressure doesn't reach a tube without lips");
+        params.connected_to_lip = 1;
+    }
+
+    /* snapshot, continue, restore and continue again */
+    stateSize = trombone_get_state_size (engine);
+    state = (double*) malloc (stateSize * sizeof (double));
+    check (trombone_save_state (engine, state, 1, &written) == TROMBONE_ERROR_BUFFER_TOO_SMALL, "small buffer is rejected");
+    check (trombone_save_state (engine, state, stateSize, &written) == TROMBONE_OK, "save state");
+    check (written > 0 && written <= stateSize, "state size");
+
+    process (engine, expected, BLOCK_SIZE);
+    check (trombone_load_state (engine, state, written) == TROMBONE_OK, "load state");
+    process (engine, output, BLOCK_SIZE);
+    check (memcmp (output, expected, sizeof (output)) == 0, "restored state continues bit-exactly");
+    check (trombone_load_state (engine, state, 3) == TROMBONE_ERROR_INCOMPATIBLE_STATE, "truncated state is rejected");
+    free (state);
+
+    /* telemetry (not available on every platform, but mustn't change the output) */
+    check (trombone_enable_telemetry (NULL, NULL) == TROMBONE_ERROR_INVALID_ARGUMENT, "no engine for telemetry");
+    i = trombone_enable_telemetry (engine, NULL);
+    check (i == TROMBONE_OK || i == TROMBONE_ERROR_UNAVAILABLE, "enable telemetry");
+
+    /* taps: the mouthpiece, the bell end and the lip */
+    {
+        trombone_tap taps[3] = { { TROMBONE_TAP_PRESSURE, 0.0 }, { TROMBONE_TAP_PRESSURE_FROM_BELL, 0.0 }, { TROMBONE_TAP_LIP_DISPLACEMENT, 0.0 } };
+        float tapOutput[3][BLOCK_SIZE];
+        float* tapOutputs[3] = { tapOutput[0], tapOutput[1], tapOutput[2] };
+        double tapPeak[3] = { 0, 0, 0 };
+        int finite = 1;
+        int t, n;
+
+        check (trombone_set_taps (engine, taps, 3, BLOCK_SIZE) == TROMBONE_OK, "set taps");
+        check (trombone_process_taps (engine, output, tapOutputs, BLOCK_SIZE + 1) == TROMBONE_ERROR_INVALID_ARGUMENT, "block larger than the taps are prepared for");
+        check (trombone_process_taps (engine, output, tapOutputs, BLOCK_SIZE) == TROMBONE_OK, "process taps");
+        for (t = 0; t < 3; ++t)
+            for (n = 0; n < BLOCK_SIZE; ++n)
+            {
+                finite = finite && isfinite (tapOutput[t][n]);
+                if (fabs (tapOutput[t][n]) > tapPeak[t])
+                    tapPeak[t] = fabs (tapOutput[t][n]);
+            }
+        check (finite, "taps are finite");
+        check (tapPeak[0] > 0, "mouthpiece tap is nonzero");
+        check (trombone_set_taps (engine, NULL, 0, 0) == TROMBONE_OK, "remove taps");
+    }
+
+    /* controls */
+    trombone_set_slide_length (engine, trombone_get_slide_length (engine, 207.65));
+    trombone_set_lip_frequency (engine, 207.65);
+    trombone_set_temperature (engine, 20);
+
+    /* a hand in the bell: the areas of the last 10 cm, from the bell end inwards */
+    {
+        double areas[2] = { 0.002, -1 };
+        check (trombone_set_areas (engine, 0.0, 0.1, areas, 2, 1) == TROMBONE_ERROR_INVALID_ARGUMENT, "negative area is rejected");
+        check (trombone_set_areas (engine, 100.0, 0.1, areas, 1, 1) == TROMBONE_ERROR_INVALID_ARGUMENT, "range outside the tube is rejected");
+        areas[1] = 0.004;
+        check (trombone_set_areas (engine, 0.0, 0.1, areas, 2, 1) == TROMBONE_OK, "set areas");
+    }
+    for (i = 0; i < 20; ++i)
+        check (process (engine, output, BLOCK_SIZE) >= 0, "output is finite after changing the controls");
+
+    trombone_get_stats (engine, &stats);
+    check (stats.samples_processed == (uint64_t) ((int) (FS / BLOCK_SIZE) + 23) * BLOCK_SIZE, "samples processed");
+    check (stats.ns_per_sample > 0 && stats.max_load >= stats.last_load, "timing");
+    check (stats.recoveries == 0 && stats.disabled == 0, "watchdog didn't trip");
+    check (stats.L > params.L && stats.T < params.T, "slide and temperature moved");
+    printf ("%.1f ns per sample (load %.3f), peak %g\n", stats.ns_per_sample, stats.max_load, peak);
+
+    trombone_destroy (engine);
+
+    /* invalid parameters */
+    params.L = -1;
+    error[0] = 0;
+    check (trombone_create (&params, FS, error, sizeof (error)) == NULL, "invalid parameters are rejected");
+    check (strlen (error) > 0, "error message");
+    check (trombone_create (NULL, FS, NULL, 0) == NULL, "no parameters");
+
+    if (failures > 0)
+        return 1;
+
+    printf ("OK\n");
+    return 0;
+}
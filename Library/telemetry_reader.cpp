@@ -0,0 +1,20 @@
+/*
+    Tails the telemetry segment of a running instance (the app or a host of
+    libtrombone that called trombone_enable_telemetry()):
+
+        trombone_telemetry --pid=<pid> [--instance=<n>] [--interval=100] [--count=0]
+        trombone_telemetry --name=/trombone-<pid>
+
+    Only reads the shared memory, it doesn't load the library.
+*/
+
+#include <JuceHeader.h>
+#include "Telemetry.h"
+
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add (argv[i]);
+    return TelemetryReader::runFromCommandLine (args.joinIntoString (" "));
+}
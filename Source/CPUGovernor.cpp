@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    CPUGovernor.cpp
+    Created: 19 Oct 2026 10:02:11am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "CPUGovernor.h"
+
+//==============================================================================
+CPUGovernor::CPUGovernor()
+{
+    oOTicksPerSecond = 1.0 / static_cast<double> (Time::getHighResolutionTicksPerSecond());
+}
+
+CPUGovernor::~CPUGovernor()
+{
+}
+
+void CPUGovernor::prepare (int samplesPerBlockExpected, double sampleRate)
+{
+    fs = sampleRate;
+    oOFs = 1.0 / fs;
+
+    // the same smoothing time whatever the block size (0.5 per block at 512 samples and 44.1 kHz)
+    double blockTime = jmax (samplesPerBlockExpected, 1) * oOFs;
+    loadFilterCoeff = 1.0 - exp (-blockTime / loadSmoothingTime);
+    blocksAbove = 0;
+    blocksBelow = 0;
+    level = fullQuality;
+    smoothedLoad = 0;
+    resetCounters();
+}
+
+void CPUGovernor::endBlock (int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    double elapsed = (Time::getHighResolutionTicks() - startTicks) * oOTicksPerSecond;
+    double load = elapsed / (numSamples * oOFs);
+    lastCallbackTime = elapsed;
+    lastLoad = load;
+
+    if (load >= 1.0)
+        ++xruns;
+    else if (load >= nearMissThreshold)
+        ++nearMisses;
+
+    if (load > peakLoad.load())
+        peakLoad = load;
+
+    // one-pole smoothing so that a single slow block doesn't switch levels, xruns always count
+    double curLoad = smoothedLoad.load();
+    curLoad += loadFilterCoeff * (load - curLoad);
+    smoothedLoad = curLoad;
+
+    if (curLoad > degradeThreshold || load >= 1.0)
+    {
+        blocksBelow = 0;
+        if (++blocksAbove >= blocksBeforeDegrade || load >= 1.0)
+        {
+            stepDown();
+            blocksAbove = 0;
+        }
+    }
+    else if (curLoad < recoverThreshold)
+    {
+        blocksAbove = 0;
+        if (++blocksBelow >= blocksBeforeRecover)
+        {
+            stepUp();
+            blocksBelow = 0;
+        }
+    }
+    else
+    {
+        blocksAbove = 0;
+        blocksBelow = 0;
+    }
+}
+
+void CPUGovernor::stepDown()
+{
+    int maxLevel = internalRateReductionAvailable ? reducedInternalRate : reducedVisualisation;
+    if (level.load() < maxLevel)
+        ++level;
+}
+
+void CPUGovernor::stepUp()
+{
+    if (level.load() > fullQuality)
+        --level;
+}
+
+void CPUGovernor::resetCounters()
+{
+    xruns = 0;
+    nearMisses = 0;
+    peakLoad = 0;
+}
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    CPUGovernor.h
+    Created: 19 Oct 2026 10:02:11am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Measures the time spent in the audio callback against the block budget
+    (numSamples / fs) and steps the quality level down when the load gets too
+    close to the deadline. Levels are only stepped back up after the load has
+    stayed low for a while (hysteresis).
+
+    The audio thread calls beginBlock() / endBlock(), everything else is read
+    from the message thread through atomics.
+*/
+class CPUGovernor
+{
+public:
+    enum Level
+    {
+        fullQuality = 0,
+        noFileOutput,           // disable Trombone::saveToFiles()
+        reducedEnergy,          // calculate the (O(N)) energy only every energyIntervalDegraded samples
+        reducedVisualisation,   // lower the repaint rate
+        reducedInternalRate,    // only used if the engine supports a resampled internal rate
+        numLevels
+    };
+
+    CPUGovernor();
+    ~CPUGovernor();
+
+    void prepare (int samplesPerBlockExpected, double sampleRate);
+
+    void beginBlock() { startTicks = Time::getHighResolutionTicks(); };
+    void endBlock (int numSamples);
+
+    // set to true if the engine has a resampled internal rate that can be dropped
+    void setInternalRateReductionAvailable (bool available) { internalRateReductionAvailable = available; };
+
+    Level getLevel() const { return static_cast<Level> (level.load()); };
+
+    bool shouldSaveToFiles() const { return getLevel() < noFileOutput; };
+    int getEnergyInterval() const { return getLevel() >= reducedEnergy ? energyIntervalDegraded : 1; };
+    int getVisualisationRate() const { return getLevel() >= reducedVisualisation ? visualisationRateDegraded : visualisationRateFull; };
+    bool shouldReduceInternalRate() const { return getLevel() >= reducedInternalRate; };
+
+    double getLoad() const { return smoothedLoad.load(); };
+    double getPeakLoad() const { return peakLoad.load(); };
+    int getXruns() const { return xruns.load(); };
+    int getNearMisses() const { return nearMisses.load(); };
+
+    // of the last block, only for the audio thread
+    double getLastCallbackTime() const { return lastCallbackTime; };   // [s]
+    double getLastLoad() const { return lastLoad; };
+
+    void resetCounters();
+
+    // thresholds as a ratio of the block budget
+    double degradeThreshold = 0.8;
+    double recoverThreshold = 0.5;
+    double nearMissThreshold = 0.9;
+
+    // number of consecutive blocks above / below the threshold before changing the level
+    int blocksBeforeDegrade = 4;
+    int blocksBeforeRecover = 200;
+
+    // time constant of the smoothed load [s], applied at prepare()
+    double loadSmoothingTime = 0.0168;
+
+    int energyIntervalDegraded = 64;
+    int visualisationRateFull = 15;
+    int visualisationRateDegraded = 5;
+
+private:
+    void stepDown();
+    void stepUp();
+
+    double fs = 44100.0;
+    double oOFs = 1.0 / 44100.0;
+    int64 startTicks = 0;
+    double oOTicksPerSecond;
+
+    double loadFilterCoeff = 0.5;
+    double lastCallbackTime = 0;
+    double lastLoad = 0;
+
+    int blocksAbove = 0;
+    int blocksBelow = 0;
+
+    bool internalRateReductionAvailable = false;
+
+    std::atomic<int> level { fullQuality };
+    std::atomic<double> smoothedLoad { 0 };
+    std::atomic<double> peakLoad { 0 };
+    std::atomic<int> xruns { 0 };
+    std::atomic<int> nearMisses { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CPUGovernor)
+};
@@ -0,0 +1,242 @@
+/*
+  ==============================================================================
+
+    ControlStream.cpp
+    Created: 20 Oct 2026 11:41:17pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ControlStream.h"
+#include "Trombone.h"
+#include "TromboneEngine.h"
+#include "HybridTrombone.h"
+#include "ConvolutionTrombone.h"
+
+//==============================================================================
+void ControlStream::prepareToRecord (double sampleRateToUse, const TromboneParameters& parametersToUse, int maxNumEvents)
+{
+    sampleRate = sampleRateToUse;
+    parameters = parametersToUse;
+    numSamples = 0;
+    numDropped = 0;
+
+    events.clear();
+    events.reserve (maxNumEvents);
+
+    lastValues[pressure] = parameters.Pm;
+    lastValues[lipFrequency] = parameters.f0;
+    lastValues[slideLength] = parameters.L;
+    lastValues[temperature] = parameters.T;
+}
+
+bool ControlStream::record (int64 sample, Type type, double value)
+{
+    lastValues[type] = value;
+    numSamples = jmax (numSamples, sample);
+
+    // never reallocate on the audio thread
+    if (events.size() == events.capacity())
+    {
+        ++numDropped;
+        return false;
+    }
+    events.push_back ({ sample, type, value });
+    return true;
+}
+
+//==============================================================================
+bool ControlStream::writeToFile (const File& file) const
+{
+    file.deleteFile();
+    FileOutputStream stream (file);
+    if (!stream.openedOk())
+        return false;
+
+    stream.writeInt (fileId);
+    stream.writeInt (version);
+    stream.writeDouble (sampleRate);
+    stream.writeInt64 (numSamples);
+
+    // the parameters bit-exactly (the presets are rounded), by name so that new parameters don't break old files
+    TromboneParameters copy = parameters;
+    int numValues = 1;
+    copy.forEachValue ([&numValues] (const char*, double&) { ++numValues; });
+    stream.writeInt (numValues);
+    copy.forEachValue ([&stream] (const char* name, double& value) {
+        stream.writeString (name);
+        stream.writeDouble (value);
+    });
+    stream.writeString ("connectedToLip");
+    stream.writeDouble (parameters.connectedToLip ? 1.0 : 0.0);
+    for (auto& values : parameters.geometry)
+        for (double value : values)
+            stream.writeDouble (value);
+
+    stream.writeInt (static_cast<int> (events.size()));
+    int64 prevSample = 0;
+    for (auto& event : events)
+    {
+        stream.writeCompressedInt (static_cast<int> (event.sample - prevSample));
+        stream.writeByte (static_cast<char> (event.type));
+        stream.writeDouble (event.value);
+        prevSample = event.sample;
+    }
+    stream.flush();
+    return true;
+}
+
+bool ControlStream::readFromFile (const File& file, String& error)
+{
+    FileInputStream stream (file);
+    if (!stream.openedOk())
+    {
+        error = "Can't open " + file.getFullPathName();
+        return false;
+    }
+    if (stream.readInt() != fileId || stream.readInt() != version)
+    {
+        error = file.getFullPathName() + " isn't a control stream (or has an unsupported version)";
+        return false;
+    }
+
+    sampleRate = stream.readDouble();
+    numSamples = stream.readInt64();
+
+    parameters = TromboneParameters();
+    int numValues = stream.readInt();
+    for (int i = 0; i < numValues; ++i)
+    {
+        String name = stream.readString();
+        double value = stream.readDouble();
+        if (name == "connectedToLip")
+            parameters.connectedToLip = value != 0;
+        parameters.forEachValue ([&] (const char* paramName, double& param) {
+            if (name == paramName)
+                param = value;
+        });
+    }
+    for (auto& values : parameters.geometry)
+        for (double& value : values)
+            value = stream.readDouble();
+
+    int numEvents = stream.readInt();
+    if (numEvents < 0 || (numEvents > 0 && stream.isExhausted()))
+    {
+        error = file.getFullPathName() + " is truncated";
+        return false;
+    }
+
+    events.clear();
+    events.reserve (numEvents);
+    int64 sample = 0;
+    for (int i = 0; i < numEvents; ++i)
+    {
+        sample += stream.readCompressedInt();
+        int type = stream.readByte();
+        double value = stream.readDouble();
+        if (type < 0 || type >= numTypes)
+        {
+            error = "Unknown event type " + String (type) + " in " + file.getFullPathName();
+            return false;
+        }
+        events.push_back ({ sample, static_cast<Type> (type), value });
+    }
+    return true;
+}
+
+//==============================================================================
+int ControlStream::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+    File file = File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--replay").unquoted());
+    String engineName = args.containsOption ("--engine") ? args.getValueForOption ("--engine") : "trombone";
+    int numRepeats = args.containsOption ("--repeat") ? jmax (1, args.getValueForOption ("--repeat").getIntValue()) : 1;
+
+    ControlStream stream;
+    String error;
+    if (!stream.readFromFile (file, error))
+    {
+        std::cout << error << std::endl;
+        return 1;
+    }
+
+    double k = 1.0 / stream.sampleRate;
+    if (!stream.parameters.validate (k, error))
+    {
+        std::cout << "Invalid parameters in " << file.getFullPathName() << ": " << error << std::endl;
+        return 1;
+    }
+
+    std::vector<float> reference (static_cast<size_t> (stream.numSamples));
+    std::vector<float> output (reference.size());
+
+    // every repetition starts from a new engine, the fastest one counts
+    auto measure = [&] (auto createEngine, std::vector<float>& out, int& numUnsupported) {
+        double best = std::numeric_limits<double>::max();
+        for (int r = 0; r < numRepeats; ++r)
+        {
+            auto engine = createEngine();
+            double start = Time::getMillisecondCounterHiRes();
+            numUnsupported = stream.replay (*engine, out.data(), stream.numSamples);
+            best = jmin (best, (Time::getMillisecondCounterHiRes() - start) * 1e6 / jmax (static_cast<int64> (1), stream.numSamples));
+        }
+        return best;
+    };
+
+    int numUnsupported = 0;
+    double referenceTime = measure ([&] {
+        auto trombone = std::make_unique<Trombone> (stream.parameters, k);
+        trombone->setEnergyInterval (std::numeric_limits<int>::max());
+        return trombone;
+    }, reference, numUnsupported);
+
+    std::cout << file.getFileName() << ": " << stream.numSamples / stream.sampleRate << " s at " << stream.sampleRate << " Hz, "
+              << stream.events.size() << " control changes" << std::endl
+              << "trombone: " << referenceTime << " ns/sample" << std::endl;
+
+    if (engineName == "trombone")
+        return 0;
+
+    // the controls of the stream that a fixed grid doesn't have
+    int features = 0;
+    for (auto& event : stream.events)
+        features |= event.type == slideLength ? TromboneEngine::slide : (event.type == temperature ? TromboneEngine::temperature : 0);
+
+    double time = 0;
+    if (engineName == "fixed")
+    {
+        time = measure ([&] { return TromboneEngine::create (stream.parameters, k, features); }, output, numUnsupported);
+        if (!TromboneEngine::create (stream.parameters, k, features)->hasFixedGrid())
+            engineName << " (no fixed grid)";
+    }
+    else if (engineName == "hybrid")
+        time = measure ([&] { return std::make_unique<HybridTrombone> (stream.parameters, k); }, output, numUnsupported);
+    else if (engineName == "convolution")
+        time = measure ([&] { return std::make_unique<ConvolutionTrombone> (stream.parameters, k); }, output, numUnsupported);
+    else
+    {
+        std::cout << "Unknown engine " << engineName << " (trombone, fixed, hybrid or convolution)" << std::endl;
+        return 1;
+    }
+
+    double maxDiff = 0;
+    double peak = 0;
+    for (size_t n = 0; n < output.size(); ++n)
+    {
+        maxDiff = jmax (maxDiff, static_cast<double> (std::abs (output[n] - reference[n])));
+        peak = jmax (peak, static_cast<double> (std::abs (reference[n])));
+    }
+
+    std::cout << engineName << ": " << time << " ns/sample, ";
+    if (maxDiff == 0)
+        std::cout << "identical to trombone";
+    else
+        std::cout << "max difference " << (peak > 0 ? maxDiff / peak : maxDiff) << " of the peak";
+    if (numUnsupported > 0)
+        std::cout << " (" << numUnsupported << " slide / temperature changes not supported)";
+    std::cout << std::endl;
+    return 0;
+}
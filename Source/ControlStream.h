@@ -0,0 +1,195 @@
+/*
+  ==============================================================================
+
+    ControlStream.h
+    Created: 20 Oct 2026 11:41:17pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "TromboneParameters.h"
+
+//==============================================================================
+/*
+    All control changes of a performance (mouth pressure, lip frequency,
+    slide and temperature) with the sample at which they were applied, plus
+    the sample rate and parameters the engine was created with. Whatever
+    produced the changes (mouse, MIDI, ...) is recorded as the values that
+    reached the engine, so replaying a stream into a new engine gives exactly
+    the same output as the performance.
+
+    Recording: prepareToRecord() on the message thread, then record() (or
+    recordIfChanged()) from the audio thread doesn't allocate. Events that
+    don't fit are dropped and counted.
+
+    Files are binary (about 10 bytes per event, the sample is stored as the
+    difference with the previous event).
+
+    Usage: Trombone --replay=controls.trcs [--engine=trombone|fixed|hybrid|convolution] [--repeat=3]
+*/
+class ControlStream
+{
+public:
+    enum Type
+    {
+        pressure = 0,       // Pm (scaled by Global::pressureMultiplier, as LipModel::setPressureVal())
+        lipFrequency,       // f0 [Hz]
+        slideLength,        // target L [m]
+        temperature,        // target T [C]
+        numTypes
+    };
+
+    struct Event
+    {
+        int64 sample;
+        Type type;
+        double value;
+    };
+
+    ControlStream() {};
+
+    //==========================================================================
+    // the last recorded values start at the parameters (which are what the engine starts with)
+    void prepareToRecord (double sampleRate, const TromboneParameters& parametersToUse, int maxNumEvents);
+
+    // for values the engine doesn't start at exactly (Tube can round L to the grid)
+    void setInitialValue (Type type, double value) { lastValues[type] = value; };
+
+    // events need to be recorded in order, returns false if the event was dropped
+    bool record (int64 sample, Type type, double value);
+    void recordIfChanged (int64 sample, Type type, double value)
+    {
+        if (value != lastValues[type])
+            record (sample, type, value);
+    };
+    void setNumSamples (int64 numSamplesToUse) { numSamples = numSamplesToUse; };
+
+    int getNumDropped() { return numDropped; };
+
+    //==========================================================================
+    bool writeToFile (const File& file) const;
+    bool readFromFile (const File& file, String& error);
+
+    //==========================================================================
+    /*
+        Drives engine with the events and writes numSamples samples of
+        engine.getOutput() to output. Lip changes are applied with
+        setInputParams() followed by refreshLipModelInputParams() (if the
+        engine has it), the slide and temperature with setTargetL() and
+        setTemperature(). Engines with process (float*, int) are rendered in
+        blocks between events, others per sample. Returns the number of
+        events the engine couldn't apply (no slide or temperature), for those
+        engines the replay isn't equivalent.
+    */
+    template <class Engine>
+    int replay (Engine& engine, float* output, int64 numSamplesToRender) const
+    {
+        double curPressure = parameters.Pm;
+        double curLipFreq = parameters.f0;
+        int numUnsupported = 0;
+
+        size_t e = 0;
+        for (int64 n = 0; n < numSamplesToRender;)
+        {
+            bool lipChanged = false;
+            for (; e < events.size() && events[e].sample <= n; ++e)
+            {
+                const Event& event = events[e];
+                switch (event.type)
+                {
+                    case pressure:
+                        curPressure = event.value;
+                        lipChanged = true;
+                        break;
+                    case lipFrequency:
+                        curLipFreq = event.value;
+                        lipChanged = true;
+                        break;
+                    case slideLength:
+                        numUnsupported += setTargetL (engine, event.value, 0) ? 0 : 1;
+                        break;
+                    case temperature:
+                        numUnsupported += setTemperature (engine, event.value, 0) ? 0 : 1;
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            if (lipChanged)
+            {
+                engine.setInputParams (curPressure, curLipFreq);
+                refreshLipModelInputParams (engine, 0);
+            }
+
+            int64 next = e < events.size() ? jmin (events[e].sample, numSamplesToRender) : numSamplesToRender;
+            int num = static_cast<int> (jmin (next - n, static_cast<int64> (1 << 30)));
+            render (engine, output + n, num, 0);
+            n += num;
+        }
+        return numUnsupported;
+    };
+
+    static int runFromCommandLine (const String& commandLine);
+
+    double sampleRate = 44100.0;
+    TromboneParameters parameters;
+    int64 numSamples = 0;
+    std::vector<Event> events;
+
+    static const int fileId = 0x54524353; // "TRCS"
+    static const int version = 1;
+
+private:
+    // engines without some of the controls (the int / long argument picks the first overload that compiles)
+    // and engines that can only tell at runtime (their setter returns false)
+    template <class Setter>
+    static bool applied (Setter setter)
+    {
+        if constexpr (std::is_same<decltype (setter()), bool>::value)
+        {
+            return setter();
+        }
+        else
+        {
+            setter();
+            return true;
+        }
+    };
+
+    template <class Engine>
+    static auto setTargetL (Engine& engine, double L, int) -> decltype (engine.setTargetL (L), bool()) { return applied ([&] { return engine.setTargetL (L); }); };
+    template <class Engine>
+    static bool setTargetL (Engine&, double, long) { return false; };
+
+    template <class Engine>
+    static auto setTemperature (Engine& engine, double T, int) -> decltype (engine.setTemperature (T), bool()) { return applied ([&] { return engine.setTemperature (T); }); };
+    template <class Engine>
+    static bool setTemperature (Engine&, double, long) { return false; };
+
+    template <class Engine>
+    static auto refreshLipModelInputParams (Engine& engine, int) -> decltype (engine.refreshLipModelInputParams(), void()) { engine.refreshLipModelInputParams(); };
+    template <class Engine>
+    static void refreshLipModelInputParams (Engine&, long) {};
+
+    template <class Engine>
+    static auto render (Engine& engine, float* output, int num, int) -> decltype (engine.process (output, num), void()) { engine.process (output, num); };
+    template <class Engine>
+    static void render (Engine& engine, float* output, int num, long)
+    {
+        for (int n = 0; n < num; ++n)
+        {
+            engine.calculate();
+            output[n] = engine.getOutput();
+            engine.updateStates();
+        }
+    };
+
+    double lastValues[numTypes];
+    int numDropped = 0;
+};
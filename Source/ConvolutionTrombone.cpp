@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+    ConvolutionTrombone.cpp
+    Created: 20 Oct 2026 9:12:40am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ConvolutionTrombone.h"
+#include "Trombone.h"
+
+//==============================================================================
+ConvolutionTrombone::ConvolutionTrombone (const TromboneParameters& parameters, double k, std::vector<double> slideLengthsToUse)
+    : k (k),
+      kernelLength (static_cast<int> (ceil (kernelDuration / k))),
+      slideLengths (slideLengthsToUse),
+      convolver (blockSize, kernelLength, 2)
+{
+    if (slideLengths.empty())
+        for (int i = 0; i < 7; ++i)
+            slideLengths.push_back (std::min (parameters.LnonExtended * pow (2.0, i / 12.0), parameters.getLmax()));
+
+    // the lip sees the same tube parameters as in Trombone (these don't depend on the slide)
+    Tube tube (parameters, k);
+    double lambda = tube.getC() * k / tube.getH();
+    D = 2.0 * tube.getRho() * tube.getC() * lambda / tube.getSBar (0);
+    SHalf0 = tube.getSHalf (0);
+
+    lipModel = std::make_unique<LipModel> (parameters, k);
+    lipModel->setTubeParameters (tube.getH(), tube.getRho(), tube.getC(), tube.getSBar (0), tube.getSHalf (0));
+
+    std::vector<double> r, t;
+    for (double L : slideLengths)
+    {
+        calculateKernels (parameters, L, r, t);
+        kernels.push_back (std::make_unique<PartitionedConvolver::Kernel>());
+        convolver.prepareKernel (r, t, *kernels.back());
+    }
+
+    // start at the slide length of the parameters
+    setTargetL (parameters.L);
+    currentPosition = targetPosition;
+    convolver.setKernel (0, kernels[currentPosition].get());
+    convolver.reset();
+
+    crossfadeStep = 1.0 / std::max (1.0, crossfadeTime / k);
+}
+
+ConvolutionTrombone::~ConvolutionTrombone()
+{
+}
+
+void ConvolutionTrombone::calculateKernels (const TromboneParameters& parameters, double L, std::vector<double>& r, std::vector<double>& t)
+{
+    TromboneParameters tubeParameters = parameters;
+    tubeParameters.L = L;
+    Tube tube (tubeParameters, k);
+    tube.resetStates();
+
+    // Terminate the mouth of the tube anechoically and send in w = delta. What comes back is the reflection
+    // function, what comes out of the bell the transmission function. These don't contain the round trips,
+    // so they decay much faster than the impulse response of the tube itself.
+    r.resize (kernelLength);
+    t.resize (kernelLength);
+    double pPrev = 0;
+    for (int n = 0; n < kernelLength; ++n)
+    {
+        tube.calculateVelocity();
+
+        // pressure at the mouth without input, as in calculate()
+        double g = tube.getP (1, 0) - D * SHalf0 * tube.getV (0, 0);
+        double U = ((n == 0 ? 1.0 : 0.0) - g - pPrev) / (2.0 * D);
+
+        tube.setFlowVelocities (U, 0);
+        tube.calculatePressure();
+        tube.calculateRadiation();
+
+        double pNow = tube.getP (0, 0);
+        r[n] = pNow + pPrev - D * U;
+        t[n] = tube.getOutput();
+        pPrev = pNow;
+        tube.updateStates();
+    }
+}
+
+void ConvolutionTrombone::setTargetL (double L)
+{
+    int nearest = 0;
+    for (int i = 1; i < static_cast<int> (slideLengths.size()); ++i)
+        if (std::abs (slideLengths[i] - L) < std::abs (slideLengths[nearest] - L))
+            nearest = i;
+    targetPosition = nearest;
+}
+
+void ConvolutionTrombone::calculate()
+{
+    // move to the target at the next block (while not crossfading)
+    if (targetPosition != currentPosition && crossfade >= 1.0 && !crossfadePending)
+    {
+        convolver.setKernel (1, kernels[currentPosition].get());
+        convolver.setKernel (0, kernels[targetPosition].get());
+        currentPosition = targetPosition;
+        crossfadePending = true;
+    }
+
+    double reflected, o;
+    convolver.getOutput (0, reflected, o);
+    if (crossfade < 1.0)
+    {
+        double reflectedPrev, oPrev;
+        convolver.getOutput (1, reflectedPrev, oPrev);
+        reflected = crossfade * reflected + (1.0 - crossfade) * reflectedPrev;
+        o = crossfade * o + (1.0 - crossfade) * oPrev;
+    }
+
+    // p_n + p_{n-1} - D U_n = (r * w)_n, so without input the mouth pressure would be g
+    double g = reflected - p;
+
+    // in Tube::calculatePressure() that is p_{n-1} - D * SHalf0 * vNext
+    lipModel->setTubeStates (p, (p - g) / (D * SHalf0));
+    lipModel->calculateCollision();
+    lipModel->calculateDeltaP();
+    lipModel->calculate();
+
+    double U = lipModel->getUb() + lipModel->getUr();
+    pNext = D * U + g;
+    w = pNext + p + D * U;
+    output = o;
+}
+
+void ConvolutionTrombone::updateStates()
+{
+    lipModel->updateStates();
+    p = pNext;
+
+    if (convolver.push (w) && crossfadePending)
+    {
+        crossfade = 0.0;
+        crossfadePending = false;
+    }
+    else if (crossfade < 1.0)
+    {
+        crossfade = std::min (1.0, crossfade + crossfadeStep);
+        if (crossfade >= 1.0)
+            convolver.setKernel (1, nullptr);
+    }
+}
+
+int ConvolutionTrombone::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+    double fs = args.containsOption ("--fs") ? args.getValueForOption ("--fs").getDoubleValue() : 44100.0;
+    if (!(fs > 0))
+    {
+        std::cout << "Invalid sample rate" << std::endl;
+        return 1;
+    }
+
+    TromboneParameters parameters;
+    int numSamples = static_cast<int> (fs);
+
+    double startTime = Time::getMillisecondCounterHiRes();
+    ConvolutionTrombone convolutionTrombone (parameters, 1.0 / fs);
+    double setupTime = Time::getMillisecondCounterHiRes() - startTime;
+
+    auto measure = [numSamples] (auto& trombone) {
+        double start = Time::getMillisecondCounterHiRes();
+        float sum = 0;
+        for (int n = 0; n < numSamples; ++n)
+        {
+            trombone.calculate();
+            sum += trombone.getOutput();
+            trombone.updateStates();
+        }
+        ignoreUnused (sum);
+        return (Time::getMillisecondCounterHiRes() - start) * 1e6 / numSamples;
+    };
+
+    Trombone trombone (parameters, 1.0 / fs);
+    double fdtdTime = measure (trombone);
+    double convolutionTime = measure (convolutionTrombone);
+
+    std::cout << "fs = " << fs << " Hz, kernels of " << convolutionTrombone.getKernelLength() << " samples (set up in " << setupTime << " ms)" << std::endl
+              << "Trombone: " << fdtdTime << " ns/sample" << std::endl
+              << "ConvolutionTrombone: " << convolutionTime << " ns/sample" << std::endl;
+    return 0;
+}
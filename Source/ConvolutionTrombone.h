@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    ConvolutionTrombone.h
+    Created: 20 Oct 2026 9:12:40am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "Tube.h"
+#include "LipModel.h"
+#include "PartitionedConvolver.h"
+
+//==============================================================================
+/*
+    Fast mode of Trombone: the (linear) tube is replaced by its reflection
+    function, so the cost per voice doesn't scale with the number of grid
+    points.
+
+    The FDTD Tube is run once per slide position with the lip disconnected and
+    the mouth terminated anechoically (for the discrete scheme), sending in
+    one pulse w. The wave that comes back is the reflection function r, the
+    output at the bell the transmission function t. At run time
+        p_n + p_{n-1} - D * U_n = (r * w)_n,    output_n = (t * w)_n,
+    with w_n = p_n + p_{n-1} + D * U_n the wave going into the tube and D the
+    instantaneous response of the mouth pressure p to the flow U. r and t are
+    convolved with zero latency by a PartitionedConvolver (as one complex
+    kernel) and the LipModel is coupled exactly as in Trombone, so up to the
+    truncation of r and t the output is the same.
+
+    The tube is lossless, so r has a long (small) tail and truncating it
+    damps the resonances slightly. With kernelDuration = 0.2 s the default
+    trombone (connected to the lip) stays within 0.5 % (rms) of Trombone.
+
+    The slide snaps to the nearest of the measured slide lengths (crossfading
+    between the reflection functions), the temperature is fixed.
+*/
+class ConvolutionTrombone
+{
+public:
+    // measures the responses for all slide lengths (by default the seven positions)
+    ConvolutionTrombone (const TromboneParameters& parameters, double k, std::vector<double> slideLengths = {});
+    ~ConvolutionTrombone();
+
+    void calculate();
+    float getOutput() { return static_cast<float> (output); };
+    float getLipOutput() { return lipModel->getY(); };
+    void updateStates();
+
+    void refreshLipModelInputParams() { lipModel->refreshInputParams(); };
+    void setInputParams (double pressure, double lipFreq)
+    {
+        lipModel->setPressureVal (pressure);
+        lipModel->setLipFreqVal (lipFreq);
+    };
+    void setPressure (double pressure) { lipModel->setPressureVal (pressure); };
+    void setLipFrequency (double lipFreq) { lipModel->setLipFreqVal (lipFreq); };
+
+    // snaps to the nearest slide length that has been measured
+    void setTargetL (double L);
+    double getL() { return slideLengths[currentPosition]; };
+
+    int getKernelLength() { return kernelLength; };
+
+    static int runFromCommandLine (const String& commandLine);
+
+    // duration of the reflection and transmission functions
+    static constexpr double kernelDuration = 0.2;   // [s]
+    static const int blockSize = 64;
+    static constexpr double crossfadeTime = 0.01;   // [s]
+
+private:
+    void calculateKernels (const TromboneParameters& parameters, double L, std::vector<double>& r, std::vector<double>& t);
+
+    double k;
+    int kernelLength;
+    std::vector<double> slideLengths;
+
+    std::unique_ptr<LipModel> lipModel;
+    double D, SHalf0;
+
+    PartitionedConvolver convolver;
+    std::vector<std::unique_ptr<PartitionedConvolver::Kernel>> kernels;
+    int currentPosition = 0;
+    int targetPosition = 0;
+
+    // slot 0 is the current slide position, slot 1 the previous one while crossfading
+    double crossfade = 1.0;
+    double crossfadeStep;
+    bool crossfadePending = false;
+
+    double p = 0;       // mouth pressure
+    double pNext = 0;
+    double w = 0;
+    double output = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConvolutionTrombone)
+};
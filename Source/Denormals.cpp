@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    Denormals.cpp
+    Created: 20 Oct 2026 7:48:31pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Denormals.h"
+#include "Trombone.h"
+
+//==============================================================================
+int DenormalBenchmark::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+    double fs = args.containsOption ("--fs") ? args.getValueForOption ("--fs").getDoubleValue() : 44100.0;
+    double seconds = args.containsOption ("--seconds") ? args.getValueForOption ("--seconds").getDoubleValue() : 10.0;
+    if (!(fs > 0) || !(seconds > 0))
+    {
+        std::cout << "Invalid sample rate or duration" << std::endl;
+        return 1;
+    }
+
+    double k = 1.0 / fs;
+    const int blockSize = 512;
+    int numBlocks = static_cast<int> (ceil (seconds * fs / blockSize));
+    TromboneParameters parameters;
+    parameters.connectedToLip = true;
+
+    for (bool flushToZero : { false, true })
+    {
+        // release tail of a played note
+        Trombone trombone (parameters, k);
+        trombone.setEnergyInterval (std::numeric_limits<int>::max());
+        trombone.setCountSubnormals (true);
+
+        float peak = 0;
+        auto processBlock = [&] {
+            std::unique_ptr<ScopedFlushToZero> scopedFlushToZero (flushToZero ? new ScopedFlushToZero() : nullptr);
+            for (int n = 0; n < blockSize; ++n)
+            {
+                trombone.calculate();
+                peak = jmax (peak, std::abs (trombone.getOutput()));
+                trombone.updateStates();
+            }
+        };
+
+        for (int b = 0; b < static_cast<int> (0.5 * fs / blockSize); ++b)
+            processBlock();
+        float notePeak = peak;
+        trombone.setPressure (0);
+        trombone.refreshLipModelInputParams();
+
+        // the peak of the last second of the tail
+        double start = Time::getMillisecondCounterHiRes();
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            if (b == jmax (0, numBlocks - static_cast<int> (fs / blockSize)))
+                peak = 0;
+            processBlock();
+        }
+        double releaseTime = (Time::getMillisecondCounterHiRes() - start) * 1e6 / (numBlocks * blockSize);
+        float tailPeak = peak;
+
+        // worst case: all states in the subnormal range
+        Tube tube (parameters, k);
+        tube.resetStates();
+        start = Time::getMillisecondCounterHiRes();
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            std::unique_ptr<ScopedFlushToZero> scopedFlushToZero (flushToZero ? new ScopedFlushToZero() : nullptr);
+            for (int n = 0; n < blockSize; ++n)
+            {
+                tube.calculateVelocity();
+                tube.setFlowVelocities (b == 0 && n == 0 ? 1e-310 : 0, 0);
+                tube.calculatePressure();
+                tube.calculateRadiation();
+                tube.updateStates();
+            }
+        }
+        double subnormalTime = (Time::getMillisecondCounterHiRes() - start) * 1e6 / (numBlocks * blockSize);
+
+        std::cout << (flushToZero ? "With" : "Without") << " flush-to-zero:" << std::endl
+                  << "  release tail: " << releaseTime << " ns/sample, " << trombone.getNumSubnormals() << " subnormal states counted"
+                  << " (peak " << notePeak << " during the note, " << tailPeak << " in the last second)" << std::endl
+                  << "  subnormal tube: " << subnormalTime << " ns/sample, " << tube.countSubnormals() << " subnormal states at the end" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    Diagnostics.cpp
+    Created: 19 Oct 2026 6:02:14pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Diagnostics.h"
+
+//==============================================================================
+Diagnostics::Diagnostics() : Thread ("Trombone diagnostics")
+{
+    for (size_t i = 0; i < capacity; ++i)
+        slots[i].sequence.store (i, std::memory_order_relaxed);
+}
+
+Diagnostics::~Diagnostics()
+{
+    stopThread (1000);
+}
+
+Diagnostics Diagnostics::instance;
+
+void Diagnostics::post (Site& site, double value)
+{
+    // rate limit: only the thread that moves nextPostTime forward gets to post
+    int64 now = Time::getHighResolutionTicks();
+    int64 nextPostTime = site.nextPostTime.load (std::memory_order_relaxed);
+    int64 interval = Time::getHighResolutionTicksPerSecond() * minInterval / 1000;
+    if (now < nextPostTime || !site.nextPostTime.compare_exchange_strong (nextPostTime, now + interval, std::memory_order_relaxed))
+    {
+        site.numSuppressed.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (!instance.push ({ &site, value, now, site.numSuppressed.exchange (0, std::memory_order_relaxed) }))
+        instance.numDropped.fetch_add (1, std::memory_order_relaxed);
+}
+
+bool Diagnostics::push (const Event& event)
+{
+    size_t pos = writePos.load (std::memory_order_relaxed);
+    Slot* slot;
+    for (;;)
+    {
+        slot = &slots[pos & mask];
+        size_t sequence = slot->sequence.load (std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t> (sequence) - static_cast<std::ptrdiff_t> (pos);
+        if (diff == 0)
+        {
+            if (writePos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            return false; // full
+        }
+        else
+        {
+            pos = writePos.load (std::memory_order_relaxed);
+        }
+    }
+    slot->event = event;
+    slot->sequence.store (pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool Diagnostics::pop (Event& event)
+{
+    Slot& slot = slots[readPos & mask];
+    if (slot.sequence.load (std::memory_order_acquire) != readPos + 1)
+        return false;
+
+    event = slot.event;
+    slot.sequence.store (readPos + capacity, std::memory_order_release);
+    ++readPos;
+    return true;
+}
+
+void Diagnostics::start()
+{
+    instance.startThread();
+}
+
+void Diagnostics::stop()
+{
+    instance.stopThread (1000);
+    instance.printEvents();
+}
+
+void Diagnostics::run()
+{
+    while (!threadShouldExit())
+    {
+        printEvents();
+        wait (50);
+    }
+}
+
+void Diagnostics::printEvents()
+{
+    Event event;
+    while (pop (event))
+    {
+        String text;
+        text << "[" << String (Time::highResolutionTicksToSeconds (event.time), 3) << " s] "
+             << (event.site->level == warning ? "warning: " : "info: ")
+             << event.site->message << " (" << event.value << ") at "
+             << String (event.site->file).fromLastOccurrenceOf ("/", false, false).fromLastOccurrenceOf ("\\", false, false) << ":" << event.site->line;
+        if (event.numSuppressed > 0)
+            text << " (" << event.numSuppressed << " more since the last one)";
+        std::cout << text << std::endl;
+    }
+
+    int dropped = numDropped.load();
+    if (dropped != numDroppedReported)
+    {
+        std::cout << (dropped - numDroppedReported) << " diagnostic events dropped (queue full)" << std::endl;
+        numDroppedReported = dropped;
+    }
+}
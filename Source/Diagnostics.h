@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    Diagnostics.h
+    Created: 19 Oct 2026 6:02:14pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Diagnostic messages that can be posted from the audio thread. Posting only
+    pushes a small event (site, value, time) into a lock-free queue, the
+    formatting and printing is done by a background thread (see start()).
+    Every call site is rate limited: it posts at most once per minInterval ms
+    and the number of suppressed events is reported with the next one.
+
+    The queue is constructed at startup and the call sites are constant
+    initialised, so posting never constructs anything. Events posted before
+    start() wait in the queue (or are dropped when it is full).
+
+    Use the DIAGNOSTIC_WARNING and DIAGNOSTIC_INFO macros. Which of them are
+    compiled in is set by TROMBONE_DIAGNOSTICS_LEVEL (0: none, 1: warnings,
+    2: warnings and info), which defaults to 2 for debug and 0 for release builds.
+*/
+class Diagnostics : private Thread
+{
+public:
+    enum Level
+    {
+        warning = 1,
+        info
+    };
+
+    // a call site, the message needs to be a string literal
+    struct Site
+    {
+        constexpr Site (const char* message, int level, const char* file, int line) : message (message), level (level), file (file), line (line) {};
+
+        const char* message;
+        int level;
+        const char* file;
+        int line;
+        std::atomic<int64> nextPostTime { 0 };
+        std::atomic<int> numSuppressed { 0 };
+    };
+
+    struct Event
+    {
+        Site* site;
+        double value;
+        int64 time;                 // high resolution ticks
+        int numSuppressed;
+    };
+
+    // lock-free and wait-free for the calling thread
+    static void post (Site& site, double value);
+
+    // start / stop the thread that prints the events, starting it again is a no-op
+    static void start();
+    static void stop();
+
+    static int getNumDropped() { return instance.numDropped.load(); };
+
+    static const int minInterval = 1000;
+
+private:
+    Diagnostics();
+    ~Diagnostics() override;
+
+    void run() override;
+    bool push (const Event& event);
+    bool pop (Event& event);
+    void printEvents();
+
+    // bounded multi-producer queue (Vyukov), single consumer
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        Event event;
+    };
+    static const size_t capacity = 1024;
+    static const size_t mask = capacity - 1;
+    Slot slots[capacity];
+    std::atomic<size_t> writePos { 0 };
+    size_t readPos = 0;
+
+    std::atomic<int> numDropped { 0 };
+    int numDroppedReported = 0;
+
+    static Diagnostics instance;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Diagnostics)
+};
+
+#ifndef TROMBONE_DIAGNOSTICS_LEVEL
+ #if JUCE_DEBUG
+  #define TROMBONE_DIAGNOSTICS_LEVEL 2
+ #else
+  #define TROMBONE_DIAGNOSTICS_LEVEL 0
+ #endif
+#endif
+
+// the site has a constexpr constructor, so it is initialised at compile time (no guard on the audio thread)
+#define TROMBONE_DIAGNOSTIC(level, message, value) \
+    do { static Diagnostics::Site diagnosticSite (message, level, __FILE__, __LINE__); Diagnostics::post (diagnosticSite, value); } while (false)
+
+#if TROMBONE_DIAGNOSTICS_LEVEL >= 1
+ #define DIAGNOSTIC_WARNING(message, value) TROMBONE_DIAGNOSTIC (Diagnostics::warning, message, value)
+#else
+ #define DIAGNOSTIC_WARNING(message, value) do {} while (false)
+#endif
+
+#if TROMBONE_DIAGNOSTICS_LEVEL >= 2
+ #define DIAGNOSTIC_INFO(message, value) TROMBONE_DIAGNOSTIC (Diagnostics::info, message, value)
+#else
+ #define DIAGNOSTIC_INFO(message, value) do {} while (false)
+#endif
@@ -0,0 +1,180 @@
+/*
+  ==============================================================================
+
+    EngineAutotuner.cpp
+    Created: 20 Oct 2026 9:12:05pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "EngineAutotuner.h"
+#include "Tube.h"
+
+//==============================================================================
+EngineAutotuner::EngineAutotuner (const File& cacheFileToUse) : cacheFile (cacheFileToUse)
+{
+    // the first candidate is also the reference
+    candidates.push_back ({ "runtime", [] (const TromboneParameters& parameters, double k) {
+        return TromboneEngine::createFallback (parameters, k);
+    } });
+
+    candidates.push_back ({ "fixedGrid", [] (const TromboneParameters& parameters, double k) {
+        auto engine = TromboneEngine::create (parameters, k);
+        return engine->hasFixedGrid() ? std::move (engine) : nullptr;
+    } });
+}
+
+File EngineAutotuner::getDefaultCacheFile()
+{
+    return File::getSpecialLocation (File::userApplicationDataDirectory).getChildFile ("Trombone").getChildFile ("engine-autotune.txt");
+}
+
+String EngineAutotuner::getCacheKey (const TromboneParameters& parameters, double k)
+{
+    Tube tube (parameters, k);
+    String cpu = SystemStats::getCpuVendor() + " " + SystemStats::getCpuModel();
+    return cpu.replaceCharacter ('=', '-').trim() + ", Nint " + String (tube.getNint()) + ", M " + String (tube.getM());
+}
+
+//==============================================================================
+String EngineAutotuner::getCachedChoice (const String& key)
+{
+    if (!cacheFile.existsAsFile())
+        return {};
+
+    StringArray lines = StringArray::fromLines (cacheFile.loadFileAsString());
+    for (auto& line : lines)
+        if (line.upToLastOccurrenceOf ("=", false, false).trim() == key)
+            return line.fromLastOccurrenceOf ("=", false, false).trim();
+    return {};
+}
+
+bool EngineAutotuner::storeChoice (const String& key, const String& name)
+{
+    // keep the entries of the other cpus and grids
+    StringArray lines;
+    if (cacheFile.existsAsFile())
+        lines = StringArray::fromLines (cacheFile.loadFileAsString());
+    lines.removeEmptyStrings();
+    for (int i = lines.size(); --i >= 0;)
+        if (lines[i].upToLastOccurrenceOf ("=", false, false).trim() == key)
+            lines.remove (i);
+    lines.add (key + " = " + name);
+
+    if (!cacheFile.getParentDirectory().createDirectory())
+        return false;
+    return cacheFile.replaceWithText (lines.joinIntoString ("\n") + "\n");
+}
+
+//==============================================================================
+std::unique_ptr<TromboneEngine> EngineAutotuner::createCandidate (const String& name, const TromboneParameters& parameters, double k)
+{
+    for (auto& candidate : candidates)
+        if (candidate.name == name)
+            return candidate.create (parameters, k);
+    return nullptr;
+}
+
+std::unique_ptr<TromboneEngine> EngineAutotuner::create (const TromboneParameters& parameters, double k)
+{
+    String key = getCacheKey (parameters, k);
+    String name = getCachedChoice (key);
+
+    // a choice from an older build can name a variant that no longer exists (or isn't available for the grid)
+    if (auto engine = createCandidate (name, parameters, k))
+    {
+        cacheHit = true;
+        return engine;
+    }
+
+    cacheHit = false;
+    name = calibrate (parameters, k);
+    cacheWriteFailed = !storeChoice (key, name);
+
+    return createCandidate (name, parameters, k);
+}
+
+String EngineAutotuner::calibrate (const TromboneParameters& parameters, double k)
+{
+    results.clear();
+    std::vector<float> reference (numCalibrationSamples), output (numCalibrationSamples);
+
+    for (auto& candidate : candidates)
+    {
+        Result result;
+        result.name = candidate.name;
+        result.time = std::numeric_limits<double>::max();
+
+        for (int r = 0; r < numRepetitions; ++r)
+        {
+            auto engine = candidate.create (parameters, k);
+            if (engine == nullptr)
+                break;
+
+            engine->setInputParams (parameters.Pm, parameters.f0);
+            double start = Time::getMillisecondCounterHiRes();
+            for (int n = 0; n < numCalibrationSamples; n += 512)
+                engine->process (output.data() + n, jmin (512, numCalibrationSamples - n));
+            result.time = jmin (result.time, (Time::getMillisecondCounterHiRes() - start) * 1e6 / numCalibrationSamples);
+        }
+
+        // not available for this grid
+        if (result.time == std::numeric_limits<double>::max())
+            continue;
+
+        if (results.empty())
+            reference = output;
+
+        float peak = 0;
+        for (int n = 0; n < numCalibrationSamples; ++n)
+        {
+            peak = jmax (peak, std::abs (reference[n]));
+            result.maxError = jmax (result.maxError, static_cast<double> (std::abs (output[n] - reference[n])));
+        }
+        if (peak > 0)
+            result.maxError /= peak;
+        result.passed = result.maxError <= tolerance;
+
+        results.push_back (result);
+    }
+
+    // the reference always passes
+    const Result* fastest = &results[0];
+    for (auto& result : results)
+        if (result.passed && result.time < fastest->time)
+            fastest = &result;
+    return fastest->name;
+}
+
+//==============================================================================
+int EngineAutotuner::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+    double fs = args.containsOption ("--fs") ? args.getValueForOption ("--fs").getDoubleValue() : 44100.0;
+
+    TromboneParameters parameters;
+    String error;
+    if (!parameters.validate (1.0 / fs, error))
+    {
+        std::cout << error << std::endl;
+        return 1;
+    }
+
+    EngineAutotuner autotuner;
+    String key = autotuner.getCacheKey (parameters, 1.0 / fs);
+    if (args.containsOption ("--recalibrate"))
+        autotuner.storeChoice (key, {});
+
+    auto engine = autotuner.create (parameters, 1.0 / fs);
+    for (auto& result : autotuner.getResults())
+        std::cout << result.name << ": " << result.time << " ns/sample, max error " << result.maxError
+                  << (result.passed ? "" : " (rejected)") << std::endl;
+
+    std::cout << key << ": " << autotuner.getCachedChoice (key)
+              << (autotuner.usedCache() ? " (cached)" : "") << std::endl
+              << "cache: " << autotuner.getDefaultCacheFile().getFullPathName()
+              << (autotuner.failedToWriteCache() ? " (could not be written)" : "") << std::endl;
+    return engine != nullptr ? 0 : 1;
+}
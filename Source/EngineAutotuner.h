@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    EngineAutotuner.h
+    Created: 20 Oct 2026 9:12:05pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "TromboneEngine.h"
+
+//==============================================================================
+/*
+    Picks the fastest TromboneEngine variant for this machine and grid. Every
+    candidate that is available for the grid is checked against the reference
+    (the runtime sized Trombone) and timed on a short run, the fastest one
+    that matches within the tolerance wins. The choice is stored in a cache
+    file keyed by the cpu model and the grid size (Nint and M), so only the
+    first start on a machine (or with a new grid) calibrates.
+
+    The candidates are the fixed-slide TromboneEngine variants, so only the
+    offline renders with a fixed slide and temperature can use the choice: the
+    app and the C API need a slide and temperature that move, which only
+    Trombone has. That's why nothing calibrates at startup, run this once
+    per machine instead.
+
+    Usage: Trombone --autotune [--fs=44100] [--recalibrate]
+*/
+class EngineAutotuner
+{
+public:
+    struct Candidate
+    {
+        String name;
+        // returns nullptr if the variant isn't available for the grid
+        std::function<std::unique_ptr<TromboneEngine> (const TromboneParameters&, double)> create;
+    };
+
+    struct Result
+    {
+        String name;
+        double time = 0;            // [ns/sample]
+        double maxError = 0;        // relative to the peak of the reference output
+        bool passed = false;
+    };
+
+    EngineAutotuner (const File& cacheFileToUse = getDefaultCacheFile());
+
+    // the cached choice for the grid, or calibrates (and caches) first
+    std::unique_ptr<TromboneEngine> create (const TromboneParameters& parameters, double k);
+
+    // always benchmarks all candidates, returns the name of the winner
+    String calibrate (const TromboneParameters& parameters, double k);
+
+    const std::vector<Result>& getResults() { return results; };
+    bool usedCache() { return cacheHit; };
+    bool failedToWriteCache() { return cacheWriteFailed; };
+
+    String getCacheKey (const TromboneParameters& parameters, double k);
+    String getCachedChoice (const String& key);
+    bool storeChoice (const String& key, const String& name);
+
+    static File getDefaultCacheFile();
+    static int runFromCommandLine (const String& commandLine);
+
+    int numCalibrationSamples = 4096;
+    int numRepetitions = 3;         // the fastest repetition counts
+    double tolerance = 1e-6;
+
+private:
+    std::unique_ptr<TromboneEngine> createCandidate (const String& name, const TromboneParameters& parameters, double k);
+
+    File cacheFile;
+    std::vector<Candidate> candidates;
+    std::vector<Result> results;
+    bool cacheHit = false;
+    bool cacheWriteFailed = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EngineAutotuner)
+};
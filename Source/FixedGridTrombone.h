@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+
+    FixedGridTrombone.h
+    Created: 20 Oct 2026 5:03:22pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "Tube.h"
+#include "TubeScheme.h"
+#include "LipModel.h"
+
+//==============================================================================
+/*
+    Trombone with the size of the grid (Nint points, split at M) known at
+    compile time. The states and coefficients are arrays inside the object,
+    so it doesn't allocate (the Tube that calculates the coefficients at
+    construction does) and all loops have constant trip counts.
+
+    The tube is updated with the same TubeScheme as Tube. As the grid can't
+    change, neither can the slide, the temperature or the areas, the tube is
+    always linear and there is no energy calculation or watchdog: use
+    Trombone for that. With the same inputs, it produces exactly the same
+    output as a Trombone. Use TromboneEngine::create() to get one for the
+    stock sample rates (it falls back to a Trombone for everything else).
+*/
+template <int Nint, int M>
+class FixedGridTrombone
+{
+public:
+    static constexpr int Mw = Nint - M;
+    static_assert (M > 1 && Mw > 1, "both systems need at least two intervals");
+
+    FixedGridTrombone (const TromboneParameters& parameters, double k) : lipModel (parameters, k)
+    {
+        // use a Tube to calculate the geometry, coefficients and initial states
+        Tube tube (parameters, k);
+        jassert (tube.Nint == Nint && tube.M == M);
+        lipModel.setTubeParameters (tube.h, tube.rho, tube.c, tube.SBar[0], tube.SHalf[0]);
+
+        outputIdx = static_cast<int> (tube.N - 1);
+
+        lambdaOverRhoC = tube.lambdaOverRhoC;
+        rhoCLambda = tube.rho * tube.c * tube.lambda;
+
+        std::copy (tube.oOSBar.begin(), tube.oOSBar.begin() + Nint + 1, oOSBar.begin());
+        std::copy (tube.SHalf.begin(), tube.SHalf.begin() + Nint, SHalf.begin());
+
+        JunctionInterpolator::calculateCoefficients (tube.N - tube.Nint, ipOwn, ipOther);
+
+        z1 = tube.z1;
+        z2 = tube.z2;
+        z3 = tube.z3;
+        z4 = tube.z4;
+        oORadTerm = tube.oORadTerm;
+        kOver2Lr = k / (2.0 * tube.Lr);
+
+        for (int n = 0; n < 2; ++n)
+        {
+            std::copy (tube.up[n], tube.up[n] + M + 1, upArrays[n].begin());
+            std::copy (tube.uv[n], tube.uv[n] + M, uvArrays[n].begin());
+            std::copy (tube.wp[n], tube.wp[n] + Mw + 1, wpArrays[n].begin());
+            std::copy (tube.wv[n], tube.wv[n] + Mw, wvArrays[n].begin());
+            up[n] = upArrays[n].data();
+            uv[n] = uvArrays[n].data();
+            wp[n] = wpArrays[n].data();
+            wv[n] = wvArrays[n].data();
+        }
+        uvMPh = tube.uvMPh;
+        wvmh = tube.wvmh;
+        p1 = tube.p1;
+        v1 = tube.v1;
+    }
+
+    void refreshLipModelInputParams() { lipModel.refreshInputParams(); };
+    void setInputParams (double pressure, double lipFreq)
+    {
+        lipModel.setPressureVal (pressure);
+        lipModel.setLipFreqVal (lipFreq);
+    };
+
+    // same order as Trombone::calculate()
+    void calculate()
+    {
+        calculateVelocity();
+        lipModel.setTubeStates (up[1][0], uv[0][0]);
+        lipModel.calculateCollision();
+        lipModel.calculateDeltaP();
+        lipModel.calculate();
+        calculatePressure (lipModel.getUb() + lipModel.getUr());
+        calculateRadiation();
+    }
+
+    void calculateVelocity()
+    {
+        TubeScheme::calculateVelocity (uv[0], uv[1], up[1], M, lambdaOverRhoC);
+        TubeScheme::calculateVelocity (wv[0], wv[1], wp[1], Mw, lambdaOverRhoC);
+        TubeScheme::calculateJunction (up[1], wp[1], M, ipOwn, ipOther, lambdaOverRhoC, &uvMPh, &wvmh, &uvNextMPh, &wvNextmh);
+    }
+
+    void calculatePressure (double U)
+    {
+        TubeScheme::calculatePressure (up[0], up[1], uv[0], 1, M, rhoCLambda, oOSBar.data(), SHalf.data());
+
+        // right (inner) boundary of left system
+        up[0][M] = TubeScheme::calculateBoundaryPressure (up[1][M], rhoCLambda, oOSBar[M], SHalf[M], uvNextMPh, SHalf[M-1], uv[0][M-1]);
+
+        TubeScheme::calculatePressure (wp[0], wp[1], wv[0], 1, Mw, rhoCLambda, oOSBar.data() + M, SHalf.data() + M);
+
+        // left (inner) boundary of right system
+        wp[0][0] = TubeScheme::calculateBoundaryPressure (wp[1][0], rhoCLambda, oOSBar[M], SHalf[M], wv[0][0], SHalf[M-1], wvNextmh);
+
+        // excitation
+        up[0][0] = TubeScheme::calculateExcitation (up[1][0], rhoCLambda, oOSBar[0], U, SHalf[0], uv[0][0]);
+    }
+
+    void calculateRadiation()
+    {
+        TubeScheme::calculateRadiation (&wp[0][Mw], &wp[1][Mw], &wv[0][Mw-1], &v1, &p1, &v1Next, &p1Next,
+                                        rhoCLambda, SHalf[Nint-1], oOSBar[Nint], z1, z2, z3, z4, oORadTerm, kOver2Lr);
+    }
+
+    void updateStates()
+    {
+        std::swap (up[0], up[1]);
+        std::swap (uv[0], uv[1]);
+        std::swap (wp[0], wp[1]);
+        std::swap (wv[0], wv[1]);
+
+        uvMPh = uvNextMPh;
+        wvmh = wvNextmh;
+        p1 = p1Next;
+        v1 = v1Next;
+
+        lipModel.updateStates();
+    }
+
+    // the pressure at N - 1, as Tube::getOutput()
+    float getOutput() { return outputIdx <= M ? up[1][outputIdx] : wp[1][outputIdx - M - 1]; };
+    float getLipOutput() { return lipModel.getY(); };
+
+    int getNint() { return Nint; };
+
+private:
+    LipModel lipModel;
+    int outputIdx;
+
+    double lambdaOverRhoC, rhoCLambda;
+    std::array<double, Nint + 1> oOSBar;
+    std::array<double, Nint> SHalf;
+    double ipOwn[JunctionInterpolator::numOwn];
+    double ipOther[JunctionInterpolator::numOther];
+    double z1, z2, z3, z4, oORadTerm, kOver2Lr;
+
+    // states
+    std::array<double, M + 1> upArrays[2];
+    std::array<double, M> uvArrays[2];
+    std::array<double, Mw + 1> wpArrays[2];
+    std::array<double, Mw> wvArrays[2];
+    double* up[2];
+    double* uv[2];
+    double* wp[2];
+    double* wv[2];
+
+    double uvMPh, uvNextMPh, wvmh, wvNextmh;
+    double p1, p1Next, v1, v1Next;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FixedGridTrombone)
+};
@@ -10,15 +10,21 @@
 
 #pragma once
 
+#include "Diagnostics.h"
+
 namespace Global {
     
     static double pressureMultiplier = 10.0;
     static double oOPressureMultiplier = 1.0 / pressureMultiplier;
 
     static bool setTubeTo1 = false;
-    static bool connectedToLip = false;
     static bool dontInterpolateAtStart = true;
     
+    static double lambdaMax = 0.999;
+    
+    // a nonlinear tube leaves room below the CFL limit for the convection speed (c * (1 / lambda - 1), about 38 m/s)
+    static double lambdaNonlinear = 0.9;
+    
     static std::vector<double> linspace (double start, double finish, int N)
     {
         std::vector<double> res (N, 0);
@@ -32,9 +38,8 @@ namespace Global {
     {
         if (idx >= N)
         {
-            std::cout << "Idx is outside of range" << std::endl;
+            DIAGNOSTIC_WARNING ("linspace idx is outside of range", idx);
             return -1;
-            
         }
         return start + idx * (finish - start) / static_cast<double> (N - 1);
     }
@@ -42,20 +47,20 @@ namespace Global {
     static inline double subplus (double val) { return (val + abs(val)) * 0.5; };
     
     static inline int sgn (double val) { return (0 < val) - (val < 0); };
+    
+    static inline double limit (double val, double min, double max) { return val < min ? min : (val > max ? max : val); };
 
     static double outputClamp (double val)
     {
         if (val < -1.0)
         {
-            val = -1.0;
-            std::cout << "outputClamped!!" << std::endl;
-            return val;
+            DIAGNOSTIC_WARNING ("output clamped", val);
+            return -1.0;
         }
         else if (val > 1.0)
         {
-            val = 1.0;
-            std::cout << "outputClamped!!" << std::endl;
-            return val;
+            DIAGNOSTIC_WARNING ("output clamped", val);
+            return 1.0;
         }
         return val;
     }
@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+    HeadlessAudioDevice.cpp
+    Created: 19 Oct 2026 6:48:51pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "HeadlessAudioDevice.h"
+#include "MainComponent.h"
+
+//==============================================================================
+HeadlessAudioIODevice::HeadlessAudioIODevice (int numOutputChannels) : AudioIODevice ("Headless", "Headless"),
+                                                                       Thread ("Headless audio device"),
+                                                                       numOutputChannels (numOutputChannels)
+{
+}
+
+HeadlessAudioIODevice::~HeadlessAudioIODevice()
+{
+    close();
+}
+
+StringArray HeadlessAudioIODevice::getOutputChannelNames()
+{
+    StringArray names;
+    for (int i = 0; i < numOutputChannels; ++i)
+        names.add ("Output " + String (i + 1));
+    return names;
+}
+
+BigInteger HeadlessAudioIODevice::getActiveOutputChannels() const
+{
+    BigInteger channels;
+    channels.setRange (0, numOutputChannels, true);
+    return channels;
+}
+
+String HeadlessAudioIODevice::open (const BigInteger&, const BigInteger&, double sampleRate, int bufferSizeSamples)
+{
+    close();
+    fs = sampleRate > 0 ? sampleRate : 44100.0;
+    bufferSize = bufferSizeSamples > 0 ? bufferSizeSamples : getDefaultBufferSize();
+    buffer.setSize (numOutputChannels, bufferSize);
+    opened = true;
+    return {};
+}
+
+void HeadlessAudioIODevice::close()
+{
+    stop();
+    opened = false;
+}
+
+void HeadlessAudioIODevice::start (AudioIODeviceCallback* callbackToUse)
+{
+    if (!opened || callbackToUse == nullptr)
+        return;
+
+    stop();
+
+    // prepareToPlay is called on the calling (message) thread, like the real devices do
+    callbackToUse->audioDeviceAboutToStart (this);
+    callback = callbackToUse;
+
+    callbackTimes.clear();
+    callbackTimes.reserve (1 << 20);
+    numCallbacks = 0;
+    deadlineMisses = 0;
+
+    startThread (Thread::realtimeAudioPriority);
+}
+
+void HeadlessAudioIODevice::stop()
+{
+    if (callback == nullptr)
+        return;
+
+    stopThread (2000);
+    callback->audioDeviceStopped();
+    callback = nullptr;
+}
+
+void HeadlessAudioIODevice::run()
+{
+    const double blockTime = 1000.0 * bufferSize / fs;
+    double blockStart = Time::getMillisecondCounterHiRes();
+
+    while (!threadShouldExit())
+    {
+        // the block needs to be done before the device needs the next one
+        double deadline = blockStart + blockTime;
+
+        buffer.clear();
+        double startTime = Time::getMillisecondCounterHiRes();
+        callback->audioDeviceIOCallback (nullptr, 0, buffer.getArrayOfWritePointers(), numOutputChannels, bufferSize);
+        double endTime = Time::getMillisecondCounterHiRes();
+
+        if (callbackTimes.size() < callbackTimes.capacity())
+            callbackTimes.push_back (endTime - startTime);
+        if (endTime > deadline)
+            ++deadlineMisses;
+        ++numCallbacks;
+
+        // wait for the next block like a sound card would, but don't try to catch up on missed blocks
+        blockStart = jmax (deadline, endTime);
+        double timeLeft = blockStart - Time::getMillisecondCounterHiRes();
+        if (timeLeft > 2.0)
+            wait (static_cast<int> (timeLeft - 1.0));
+        while (Time::getMillisecondCounterHiRes() < blockStart && !threadShouldExit())
+            Thread::yield();
+    }
+}
+
+void HeadlessAudioIODevice::waitForBlocks (int numBlocks)
+{
+    while (isThreadRunning() && numCallbacks.load() < numBlocks)
+        Thread::sleep (5);
+}
+
+HeadlessAudioIODevice::Statistics HeadlessAudioIODevice::getStatistics()
+{
+    jassert (!isThreadRunning()); // stop() first
+
+    Statistics statistics;
+    statistics.numCallbacks = numCallbacks.load();
+    statistics.deadlineMisses = deadlineMisses.load();
+    if (callbackTimes.empty())
+        return statistics;
+
+    std::vector<double> sorted (callbackTimes);
+    std::sort (sorted.begin(), sorted.end());
+    auto percentile = [&sorted] (double p) { return sorted[static_cast<size_t> (p * (sorted.size() - 1))]; };
+    statistics.p50 = percentile (0.5);
+    statistics.p99 = percentile (0.99);
+    statistics.max = sorted.back();
+    statistics.headroom = statistics.p99 > 0 ? (1000.0 * bufferSize / fs) / statistics.p99 : 0;
+    return statistics;
+}
+
+//==============================================================================
+int CallbackBenchmark::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+
+    auto parseList = [&args] (const String& option, const String& defaultValues) {
+        StringArray values = StringArray::fromTokens (args.containsOption (option) ? args.getValueForOption (option) : defaultValues, ",", "");
+        values.removeEmptyStrings();
+        return values;
+    };
+    StringArray sampleRates = parseList ("--fs", "44100,48000");
+    StringArray blockSizes = parseList ("--blocks", "16,64,256,1024,2048");
+    double seconds = args.containsOption ("--seconds") ? args.getValueForOption ("--seconds").getDoubleValue() : 5.0;
+    String reportName = args.getValueForOption ("--report");
+    File reportFile = File::getCurrentWorkingDirectory().getChildFile (reportName.isEmpty() ? "callback-report.csv" : reportName.unquoted());
+
+    String report;
+    report << "# Trombone callback benchmark, " << Time::getCurrentTime().toString (true, true) << ", "
+           << SystemStats::getCpuModel() << " (" << SystemStats::getNumCpus() << " cpus)\n"
+           << "fs,blockSize,callbacks,p50Ms,p99Ms,maxMs,deadlineMisses,headroom\n";
+
+    for (auto& fsString : sampleRates)
+    {
+        for (auto& blockSizeString : blockSizes)
+        {
+            double fs = fsString.getDoubleValue();
+            int blockSize = blockSizeString.getIntValue();
+            if (!(fs > 0) || blockSize < 1)
+            {
+                std::cout << "Invalid configuration: fs = " << fsString << ", block size = " << blockSizeString << std::endl;
+                return 1;
+            }
+
+            // MainComponent opens the default device (if any) itself, detach it from that first
+            MainComponent mainComponent;
+            mainComponent.shutdownAudio();
+
+            AudioSourcePlayer player;
+            player.setSource (&mainComponent);
+
+            HeadlessAudioIODevice device;
+            device.open ({}, {}, fs, blockSize);
+            device.start (&player);
+            device.waitForBlocks (static_cast<int> (ceil (seconds * fs / blockSize)));
+            device.stop();
+            player.setSource (nullptr);
+
+            auto statistics = device.getStatistics();
+            String line;
+            line << fs << "," << blockSize << "," << statistics.numCallbacks << ","
+                 << String (statistics.p50, 4) << "," << String (statistics.p99, 4) << "," << String (statistics.max, 4) << ","
+                 << statistics.deadlineMisses << "," << String (statistics.headroom, 3);
+            std::cout << line << std::endl;
+            report << line << "\n";
+        }
+    }
+
+    if (!reportFile.replaceWithText (report))
+    {
+        std::cout << "Could not write " << reportFile.getFullPathName() << std::endl;
+        return 1;
+    }
+    return 0;
+}
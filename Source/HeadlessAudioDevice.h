@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    HeadlessAudioDevice.h
+    Created: 19 Oct 2026 6:48:51pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Stand-in for a sound card on machines without audio hardware. A thread
+    calls the callback once per block, paced on the block deadlines like a real
+    device would, and records how long every callback took.
+*/
+class HeadlessAudioIODevice : public AudioIODevice, private Thread
+{
+public:
+    struct Statistics
+    {
+        int numCallbacks = 0;
+        double p50 = 0;             // callback time [ms]
+        double p99 = 0;             // callback time [ms]
+        double max = 0;             // callback time [ms]
+        int deadlineMisses = 0;     // callbacks that finished after their block deadline
+        double headroom = 0;        // block duration / p99 callback time (> 1 is real-time)
+    };
+
+    HeadlessAudioIODevice (int numOutputChannels = 2);
+    ~HeadlessAudioIODevice() override;
+
+    StringArray getOutputChannelNames() override;
+    StringArray getInputChannelNames() override { return {}; };
+    Array<double> getAvailableSampleRates() override { return { 22050.0, 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 }; };
+    Array<int> getAvailableBufferSizes() override { return { 16, 32, 64, 128, 256, 512, 1024, 2048 }; };
+    int getDefaultBufferSize() override { return 512; };
+
+    String open (const BigInteger& inputChannels, const BigInteger& outputChannels, double sampleRate, int bufferSizeSamples) override;
+    void close() override;
+    bool isOpen() override { return opened; };
+    void start (AudioIODeviceCallback* callbackToUse) override;
+    void stop() override;
+    bool isPlaying() override { return callback != nullptr; };
+    String getLastError() override { return {}; };
+
+    int getCurrentBufferSizeSamples() override { return bufferSize; };
+    double getCurrentSampleRate() override { return fs; };
+    int getCurrentBitDepth() override { return 32; };
+    BigInteger getActiveOutputChannels() const override;
+    BigInteger getActiveInputChannels() const override { return {}; };
+    int getOutputLatencyInSamples() override { return bufferSize; };
+    int getInputLatencyInSamples() override { return 0; };
+
+    // blocks (on the calling thread) until numBlocks callbacks have been done
+    void waitForBlocks (int numBlocks);
+    Statistics getStatistics();
+
+private:
+    void run() override;
+
+    int numOutputChannels;
+    double fs = 44100.0;
+    int bufferSize = 512;
+    bool opened = false;
+
+    AudioBuffer<float> buffer;
+    AudioIODeviceCallback* callback = nullptr;
+
+    std::vector<double> callbackTimes;  // [ms], reserved before the thread starts
+    std::atomic<int> numCallbacks { 0 };
+    std::atomic<int> deadlineMisses { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HeadlessAudioIODevice)
+};
+
+//==============================================================================
+/*
+    Runs MainComponent on the headless device for a grid of sample rates and
+    block sizes and writes a report (csv, one line per configuration) that can
+    be compared between builds.
+
+    Usage: Trombone --benchmark-callback [--fs=44100,48000] [--blocks=16,64,256,1024,2048]
+                    [--seconds=5] [--report=callback-report.csv]
+*/
+class CallbackBenchmark
+{
+public:
+    static int runFromCommandLine (const String& commandLine);
+};
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    HybridTrombone.cpp
+    Created: 20 Oct 2026 2:27:15pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "HybridTrombone.h"
+#include "Trombone.h"
+#include "TubeResonances.h"
+
+//==============================================================================
+HybridTrombone::HybridTrombone (const TromboneParameters& parameters, double k)
+{
+    tube = std::make_unique<HybridTube> (parameters, k);
+    lipModel = std::make_unique<LipModel> (parameters, k);
+    lipModel->setTubeParameters (tube->getH(), tube->getRho(), tube->getC(), tube->getSBar (0), tube->getSHalf (0));
+}
+
+HybridTrombone::~HybridTrombone()
+{
+}
+
+void HybridTrombone::calculate()
+{
+    tube->updateL();
+    tube->calculateVelocity();
+    lipModel->setTubeStates (tube->getP (1, 0), tube->getV (0, 0));
+    lipModel->calculateCollision();
+    lipModel->calculateDeltaP();
+    lipModel->calculate();
+    tube->setFlowVelocities (lipModel->getUb(), lipModel->getUr());
+    tube->calculatePressure();
+    tube->calculateRadiation();
+}
+
+void HybridTrombone::updateStates()
+{
+    tube->updateStates();
+    lipModel->updateStates();
+}
+
+int HybridTrombone::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+    double fs = args.containsOption ("--fs") ? args.getValueForOption ("--fs").getDoubleValue() : 44100.0;
+    if (!(fs > 0))
+    {
+        std::cout << "Invalid sample rate" << std::endl;
+        return 1;
+    }
+
+    double k = 1.0 / fs;
+    TromboneParameters parameters;
+    int numSamples = static_cast<int> (fs);
+
+    auto measure = [numSamples] (auto& trombone) {
+        double start = Time::getMillisecondCounterHiRes();
+        float sum = 0;
+        for (int n = 0; n < numSamples; ++n)
+        {
+            trombone.calculate();
+            sum += trombone.getOutput();
+            trombone.updateStates();
+        }
+        ignoreUnused (sum);
+        return (Time::getMillisecondCounterHiRes() - start) * 1e6 / numSamples;
+    };
+
+    Trombone trombone (parameters, k);
+    HybridTrombone hybridTrombone (parameters, k);
+    double fdtdTime = measure (trombone);
+    double hybridTime = measure (hybridTrombone);
+
+    std::cout << "fs = " << fs << " Hz, " << trombone.getTube().getNint() + 1 << " grid points, hybrid: "
+              << hybridTrombone.getTube().getNumGridPoints() << " grid points and "
+              << hybridTrombone.getTube().getNumWaveguideSections() << " waveguide sections" << std::endl
+              << "Trombone: " << fdtdTime << " ns/sample" << std::endl
+              << "HybridTrombone: " << hybridTime << " ns/sample" << std::endl;
+
+    // tuning at the seven slide positions (Tube starts on the grid, the hybrid at the same length)
+    const int numResonances = 10;
+    double maxDeviation = 0;
+    for (int position = 0; position < 7; ++position)
+    {
+        TromboneParameters positionParameters = parameters;
+        positionParameters.L = std::min (parameters.LnonExtended * pow (2.0, position / 12.0), parameters.getLmax());
+        Tube tube (positionParameters, k);
+        positionParameters.L = tube.getL();
+        HybridTube hybridTube (positionParameters, k);
+
+        auto reference = measureResonances (tube, k, numResonances);
+        auto resonances = measureResonances (hybridTube, k, numResonances);
+
+        std::cout << "position " << position + 1 << ":";
+        for (int i = 0; i < static_cast<int> (std::min (reference.size(), resonances.size())); ++i)
+        {
+            double cents = 1200.0 * log2 (resonances[i] / reference[i]);
+            maxDeviation = std::max (maxDeviation, std::abs (cents));
+            std::cout << " " << String (reference[i], 1) << " Hz (" << String (cents, 2) << ")";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "Largest deviation of the first " << numResonances << " resonances: " << maxDeviation << " cents" << std::endl;
+    return maxDeviation <= tuningTolerance ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    HybridTrombone.h
+    Created: 20 Oct 2026 2:27:15pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "HybridTube.h"
+#include "LipModel.h"
+
+//==============================================================================
+/*
+    Fast mode of Trombone with a HybridTube (waveguides for the cylindrical
+    sections), coupled to the LipModel in the same way.
+
+    Usage: Trombone --benchmark-hybrid [--fs=44100]
+    compares the cost per sample to Trombone and the resonances of the tubes
+    (from the pressure response to a flow impulse) at all slide positions.
+*/
+class HybridTrombone
+{
+public:
+    HybridTrombone (const TromboneParameters& parameters, double k);
+    ~HybridTrombone();
+
+    void calculate();
+    float getOutput() { return tube->getOutput(); };
+    float getLipOutput() { return lipModel->getY(); };
+    void updateStates();
+
+    void refreshLipModelInputParams() { lipModel->refreshInputParams(); };
+    void setInputParams (double pressure, double lipFreq)
+    {
+        lipModel->setPressureVal (pressure);
+        lipModel->setLipFreqVal (lipFreq);
+    };
+    void setPressure (double pressure) { lipModel->setPressureVal (pressure); };
+    void setLipFrequency (double lipFreq) { lipModel->setLipFreqVal (lipFreq); };
+    void setTargetL (double L) { tube->setTargetL (L); };
+    double getL() { return tube->getL(); };
+
+    HybridTube& getTube() { return *tube; };
+
+    static int runFromCommandLine (const String& commandLine);
+
+    // above this the tuning of HybridTube is reported as out of tolerance
+    static constexpr double tuningTolerance = 1.0;     // [cents]
+
+private:
+    std::unique_ptr<HybridTube> tube;
+    std::unique_ptr<LipModel> lipModel;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HybridTrombone)
+};
@@ -0,0 +1,275 @@
+/*
+  ==============================================================================
+
+    HybridTube.cpp
+    Created: 20 Oct 2026 2:27:15pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "HybridTube.h"
+#include "Tube.h"
+
+//==============================================================================
+HybridTube::HybridTube (const TromboneParameters& parameters, double k) : k (k), L (parameters.L), targetL (parameters.L)
+{
+    // geometry and grid spacing of Tube with the slide in
+    TromboneParameters nonExtended = parameters;
+    nonExtended.L = parameters.LnonExtended;
+    Tube tube (nonExtended, k);
+
+    h = tube.getH();
+    c = tube.getC();
+    rho = tube.getRho();
+    lambda = c * k / h;
+    lambdaOverRhoC = lambda / (rho * c);
+    rhoCLambda = rho * c * lambda;
+
+    NnonExtended = tube.getNint();
+    LMax = std::max (parameters.getLmax(), L);
+    LMin = std::min (parameters.LnonExtended, L);
+
+    std::vector<double> S (NnonExtended + 1);
+    for (int i = 0; i <= NnonExtended; ++i)
+        S[i] = tube.getS (i);
+
+    // last points of the runs of equal areas after the mouthpiece, up to the first one that is too short
+    std::vector<int> runEnds;
+    int runStart = numMouthpieceIntervals;
+    for (int i = runStart + 1; i <= NnonExtended; ++i)
+    {
+        if (S[i] == S[runStart])
+            continue;
+        if (i - 1 - runStart < minSectionIntervals)
+            break;
+        runEnds.push_back (i - 1);
+        runStart = i;
+    }
+
+    // the geometry needs at least one cylindrical section (after the mouthpiece)
+    jassert (!runEnds.empty());
+    if (runEnds.empty())
+        runEnds.push_back (numMouthpieceIntervals + minSectionIntervals);
+
+    // the bell grid starts one point before the end of the last run, so that the step is inside the grid as in Tube
+    int bellStart = runEnds.back() - 1;
+    mouthpiece.setAreas (S, 0, numMouthpieceIntervals);
+    bell.setAreas (S, bellStart, NnonExtended);
+
+    // the slide (section 1) is extended, as in Tube::calculateGeometry()
+    double totLength = 0;
+    for (double length : parameters.geometry[0])
+        totLength += length;
+    int slideStart = static_cast<int> (round (NnonExtended * parameters.geometry[0][0] / totLength));
+
+    // the junctions are halfway between the points with different areas
+    sections.resize (runEnds.size());
+    slideSection = -1;
+    double left = numMouthpieceIntervals;
+    for (int r = 0; r < static_cast<int> (sections.size()); ++r)
+    {
+        bool last = r == static_cast<int> (sections.size()) - 1;
+        double right = last ? bellStart : runEnds[r] + 0.5;
+        sections[r].intervals = right - left;
+        sections[r].reflection = last ? 0 : (S[runEnds[r]] - S[runEnds[r] + 1]) / (S[runEnds[r]] + S[runEnds[r] + 1]);
+        left = right;
+
+        if (slideSection < 0 && (slideStart <= runEnds[r] || last))
+            slideSection = r;
+    }
+
+    double maxDelay = 0;
+    for (auto& section : sections)
+        maxDelay = std::max (maxDelay, section.intervals / lambda);
+    maxDelay += (LMax / h - NnonExtended) / lambda;
+
+    int bufferSize = nextPowerOfTwo (static_cast<int> (ceil (maxDelay)) + 4);
+    mask = bufferSize - 1;
+    for (int r = 0; r < static_cast<int> (sections.size()); ++r)
+    {
+        sections[r].right.buffer.resize (bufferSize, 0);
+        sections[r].left.buffer.resize (bufferSize, 0);
+        setSectionLength (sections[r], sections[r].intervals + (r == slideSection ? L / h - NnonExtended : 0));
+    }
+
+    // radiation as in Tube::calculateRadiationCoefficients()
+    Tube::calculateRadiationCircuit (bell.SBar[bell.N], rho, c, k, R1, R2, Lr, Cr, z1, z2, z3, z4);
+    oORadTerm = 1.0 / (1.0 + rhoCLambda * z3);
+
+    resetStates();
+}
+
+HybridTube::~HybridTube()
+{
+}
+
+void HybridTube::Grid::setAreas (const std::vector<double>& S, int start, int end)
+{
+    N = end - start;
+    for (int n = 0; n < 2; ++n)
+    {
+        pVecs[n].resize (N + 1, 0);
+        vVecs[n].resize (N, 0);
+        p[n] = pVecs[n].data();
+        v[n] = vVecs[n].data();
+    }
+
+    // as in Tube::calculateAreas()
+    SHalf.resize (N);
+    SBar.resize (N + 1);
+    oOSBar.resize (N + 1);
+    for (int i = 0; i < N; ++i)
+        SHalf[i] = (S[start + i] + S[start + i + 1]) * 0.5;
+
+    SBar[0] = S[start];
+    for (int i = 0; i < N - 1; ++i)
+        SBar[i+1] = (SHalf[i] + SHalf[i+1]) * 0.5;
+    SBar[N] = S[end];
+
+    for (int i = 0; i <= N; ++i)
+        oOSBar[i] = 1.0 / SBar[i];
+}
+
+void HybridTube::Grid::swap()
+{
+    std::swap (p[0], p[1]);
+    std::swap (v[0], v[1]);
+}
+
+void HybridTube::DelayLine::setDelay (double delayInSamples)
+{
+    // taps at intDelay - 1 to intDelay + 2, so that the fractional delay t is between the middle two
+    intDelay = static_cast<int> (floor (delayInSamples));
+    jassert (intDelay >= 2);
+    double t = delayInSamples - intDelay + 1;
+    coeffs[0] = -(t - 1) * (t - 2) * (t - 3) / 6.0;
+    coeffs[1] = t * (t - 2) * (t - 3) * 0.5;
+    coeffs[2] = -t * (t - 1) * (t - 3) * 0.5;
+    coeffs[3] = t * (t - 1) * (t - 2) / 6.0;
+}
+
+void HybridTube::setSectionLength (Section& section, double intervals)
+{
+    // one grid interval takes 1 / lambda samples
+    section.right.setDelay (intervals / lambda);
+    section.left.setDelay (intervals / lambda);
+}
+
+double HybridTube::read (const DelayLine& line)
+{
+    int idx = writePos - line.intDelay + 1;
+    return line.coeffs[0] * line.buffer[idx & mask]
+         + line.coeffs[1] * line.buffer[(idx - 1) & mask]
+         + line.coeffs[2] * line.buffer[(idx - 2) & mask]
+         + line.coeffs[3] * line.buffer[(idx - 3) & mask];
+}
+
+void HybridTube::updateL()
+{
+    if (L == targetL)
+        return;
+
+    double maxStep = maxSlideSpeed * k;
+    L = targetL > L ? std::min (L + maxStep, targetL) : std::max (L - maxStep, targetL);
+    setSectionLength (sections[slideSection], sections[slideSection].intervals + L / h - NnonExtended);
+}
+
+void HybridTube::calculateVelocity (Grid& grid)
+{
+    for (int l = 0; l < grid.N; ++l)
+        grid.v[0][l] = grid.v[1][l] - lambdaOverRhoC * (grid.p[1][l+1] - grid.p[1][l]);
+}
+
+void HybridTube::calculateInterior (Grid& grid)
+{
+    for (int l = 1; l < grid.N; ++l)
+        grid.p[0][l] = grid.p[1][l] - rhoCLambda * grid.oOSBar[l] * (grid.SHalf[l] * grid.v[0][l] - grid.SHalf[l-1] * grid.v[0][l-1]);
+}
+
+void HybridTube::calculateVelocity()
+{
+    calculateVelocity (mouthpiece);
+    calculateVelocity (bell);
+}
+
+void HybridTube::calculatePressure()
+{
+    calculateInterior (mouthpiece);
+    calculateInterior (bell);
+
+    // excitation
+    mouthpiece.p[0][0] = mouthpiece.p[1][0] - rhoCLambda * mouthpiece.oOSBar[0] * (-2.0 * (Ub + Ur) + 2.0 * mouthpiece.SHalf[0] * mouthpiece.v[0][0]);
+
+    for (auto& section : sections)
+    {
+        section.right.out = read (section.right);
+        section.left.out = read (section.left);
+    }
+
+    // ports: g is the pressure at the boundary without flow from the waveguide
+    int N = mouthpiece.N;
+    double D = 2.0 * rhoCLambda * mouthpiece.oOSBar[N];
+    double g = mouthpiece.p[1][N] + D * mouthpiece.SHalf[N-1] * mouthpiece.v[0][N-1];
+    mouthpiece.p[0][N] = 2.0 * sections.front().left.out + 0.5 * (g - mouthpiece.p[1][N]);
+    sections.front().right.buffer[writePos] = 0.25 * (g + mouthpiece.p[1][N]);
+
+    D = 2.0 * rhoCLambda * bell.oOSBar[0];
+    g = bell.p[1][0] - D * bell.SHalf[0] * bell.v[0][0];
+    bell.p[0][0] = 2.0 * sections.back().right.out + 0.5 * (g - bell.p[1][0]);
+    sections.back().left.buffer[writePos] = 0.25 * (g + bell.p[1][0]);
+
+    // Kelly-Lochbaum junctions
+    for (int r = 0; r < static_cast<int> (sections.size()) - 1; ++r)
+    {
+        double x = sections[r].right.out;
+        double y = sections[r+1].left.out;
+        double w = sections[r].reflection * (x - y);
+        sections[r+1].right.buffer[writePos] = x + w;
+        sections[r].left.buffer[writePos] = y + w;
+    }
+}
+
+void HybridTube::calculateRadiation()
+{
+    int N = bell.N;
+    bell.p[0][N] = ((1.0 - rhoCLambda * z3) * bell.p[1][N] - 2.0 * rhoCLambda * (v1 + z4 * p1 - (bell.SHalf[N-1] * bell.v[0][N-1]) * bell.oOSBar[N])) * oORadTerm;
+
+    v1Next = v1 + k / (2.0 * Lr) * (bell.p[0][N] + bell.p[1][N]);
+    p1Next = z1 * 0.5 * (bell.p[0][N] + bell.p[1][N]) + z2 * p1;
+}
+
+void HybridTube::updateStates()
+{
+    mouthpiece.swap();
+    bell.swap();
+    writePos = (writePos + 1) & mask;
+
+    p1 = p1Next;
+    v1 = v1Next;
+}
+
+void HybridTube::resetStates()
+{
+    for (auto* grid : { &mouthpiece, &bell })
+    {
+        for (int n = 0; n < 2; ++n)
+        {
+            std::fill (grid->pVecs[n].begin(), grid->pVecs[n].end(), 0.0);
+            std::fill (grid->vVecs[n].begin(), grid->vVecs[n].end(), 0.0);
+        }
+    }
+    for (auto& section : sections)
+    {
+        std::fill (section.right.buffer.begin(), section.right.buffer.end(), 0.0);
+        std::fill (section.left.buffer.begin(), section.left.buffer.end(), 0.0);
+        section.right.out = 0;
+        section.left.out = 0;
+    }
+
+    p1 = 0;
+    p1Next = 0;
+    v1 = 0;
+    v1Next = 0;
+}
@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    HybridTube.h
+    Created: 20 Oct 2026 2:27:15pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "TromboneParameters.h"
+
+//==============================================================================
+/*
+    Tube with the cylindrical sections as digital waveguides: only the
+    mouthpiece end (where the lip model is connected) and everything from the
+    last cylindrical section on (tuning slide and bell) are FDTD grids.
+
+    The geometry is taken from a Tube with the slide in, so the areas and the
+    positions of the steps between the sections are the same. Every run of
+    equal areas between the two grids is a pair of fractional delay lines
+    (cubic Lagrange) and the steps are Kelly-Lochbaum junctions. The slide
+    (section 1) is one of these runs, so moving it only changes two delays.
+    The grids are connected to the waveguide by ports matched to the discrete
+    impedance of the scheme: for the incoming wave a the boundary pressure is
+    p_{n+1} = 2a + (g - p_n) / 2, where g is what it would be without flow,
+    and (g + p_n) / 4 leaves the grid.
+
+    The cost of the waveguide doesn't depend on its length, so most of the
+    grid points of Tube are gone. The temperature is fixed.
+*/
+class HybridTube
+{
+public:
+    HybridTube (const TromboneParameters& parameters, double k);
+    ~HybridTube();
+
+    // slide: at most maxSlideSpeed m/s, as in Tube
+    void setTargetL (double LIn) { targetL = Global::limit (LIn, LMin, LMax); };
+    void updateL();
+    double getL() { return L; };
+
+    void calculateVelocity();
+    void setFlowVelocities (double UbIn, double UrIn)
+    {
+        Ub = UbIn;
+        Ur = UrIn;
+    };
+    void calculatePressure();
+    void calculateRadiation();
+    void updateStates();
+    void resetStates();
+
+    // the same point as Tube::getOutput() (two points before the end of the bell)
+    float getOutput() { return bell.p[1][bell.N - 2]; };
+
+    // states of the mouthpiece grid (for the lip model)
+    double getP (int n, int l) { return mouthpiece.p[n][l]; };
+    double getV (int n, int l) { return mouthpiece.v[n][l]; };
+    double getSBar (int idx) { return mouthpiece.SBar[idx]; };
+    double getSHalf (int idx) { return mouthpiece.SHalf[idx]; };
+
+    double getH() { return h; };
+    double getRho() { return rho; };
+    double getC() { return c; };
+
+    int getNumGridPoints() { return mouthpiece.N + bell.N + 2; };
+    int getNumWaveguideSections() { return static_cast<int> (sections.size()); };
+
+    static const int numMouthpieceIntervals = 4;
+
+    // runs of equal areas that are shorter are left to the bell grid
+    static const int minSectionIntervals = 4;
+
+private:
+    struct Grid
+    {
+        void setAreas (const std::vector<double>& S, int start, int end);
+        void swap();
+
+        int N;
+        std::vector<double> pVecs[2], vVecs[2];
+        double* p[2];
+        double* v[2];
+        std::vector<double> SHalf, SBar, oOSBar;
+    };
+
+    // cubic Lagrange interpolation, the delay needs to be at least 2 samples
+    struct DelayLine
+    {
+        void setDelay (double delayInSamples);
+
+        std::vector<double> buffer;
+        int intDelay;
+        double coeffs[4];
+        double out;
+    };
+
+    struct Section
+    {
+        double intervals;           // length in grid intervals (without the slide)
+        double reflection;          // at the junction with the next section
+        DelayLine right, left;
+    };
+
+    void calculateVelocity (Grid& grid);
+    void calculateInterior (Grid& grid);
+    double read (const DelayLine& line);
+    void setSectionLength (Section& section, double intervals);
+
+    double k, h, c, rho, lambda, lambdaOverRhoC, rhoCLambda;
+    double L, targetL, LMin, LMax;
+    double maxSlideSpeed = 5.0;
+    int NnonExtended;
+
+    Grid mouthpiece, bell;
+    std::vector<Section> sections;
+    int slideSection;
+    int writePos = 0;
+    int mask;
+
+    double Ub = 0, Ur = 0;
+
+    // radiation (as in Tube)
+    double R1, Lr, R2, Cr, z1, z2, z3, z4;
+    double p1Next, p1, v1Next, v1;
+    double oORadTerm;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HybridTube)
+};
@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    ImplicitTrombone.cpp
+    Created: 21 Oct 2026 4:12:51pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ImplicitTrombone.h"
+#include "Trombone.h"
+#include "TubeResonances.h"
+#include "Denormals.h"
+
+//==============================================================================
+ImplicitTrombone::ImplicitTrombone (const TromboneParameters& parameters, double k, double courant)
+{
+    tube = std::make_unique<ImplicitTube> (parameters, k, courant);
+    lipModel = std::make_unique<LipModel> (parameters, k);
+    lipModel->setTubeParameters (tube->getH(), tube->getRho(), tube->getC(), tube->getLipSBar(), tube->getSHalf (0));
+}
+
+ImplicitTrombone::~ImplicitTrombone()
+{
+}
+
+void ImplicitTrombone::calculate()
+{
+    tube->calculateVelocity();
+    lipModel->setTubeStates (tube->getLipPressure(), 0.0);
+    lipModel->calculateCollision();
+    lipModel->calculateDeltaP();
+    lipModel->calculate();
+    tube->setFlowVelocities (lipModel->getUb(), lipModel->getUr());
+    tube->calculatePressure();
+    tube->calculateRadiation();
+}
+
+void ImplicitTrombone::updateStates()
+{
+    tube->updateStates();
+    lipModel->updateStates();
+}
+
+int ImplicitTrombone::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+    std::vector<double> courants;
+    for (auto& value : StringArray::fromTokens (args.containsOption ("--courant") ? args.getValueForOption ("--courant") : "0.999,1.5,2,3,4", ",", ""))
+        courants.push_back (value.getDoubleValue());
+    for (double courant : courants)
+    {
+        if (!(courant > 0))
+        {
+            std::cout << "Invalid Courant number" << std::endl;
+            return 1;
+        }
+    }
+
+    TromboneParameters parameters;
+    const int numResonances = 10;
+
+    // deviation [cents] of the first resonances of a tube from those of the explicit scheme on the same grid (max and rms)
+    auto tuningError = [&] (const std::vector<double>& reference, const std::vector<double>& resonances, double& maxCents, double& rmsCents) {
+        maxCents = 0;
+        rmsCents = 0;
+        int num = std::min (reference.size(), resonances.size());
+        for (int i = 0; i < num; ++i)
+        {
+            double cents = 1200.0 * log2 (resonances[i] / reference[i]);
+            maxCents = std::max (maxCents, std::abs (cents));
+            rmsCents += cents * cents;
+        }
+        rmsCents = sqrt (rmsCents / std::max (num, 1));
+    };
+
+    // one second of sound, with the lip
+    auto measure = [] (auto& trombone, double fs) {
+        ScopedFlushToZero flushToZero;
+        int numSamples = static_cast<int> (fs);
+        double start = Time::getMillisecondCounterHiRes();
+        float sum = 0;
+        for (int n = 0; n < numSamples; ++n)
+        {
+            trombone.calculate();
+            sum += trombone.getOutput();
+            trombone.updateStates();
+        }
+        ignoreUnused (sum);
+        return (Time::getMillisecondCounterHiRes() - start) * 1e6 / numSamples;
+    };
+
+    String csv = "fs,courant,theta,points,explicit fs,explicit ms/s,implicit ms/s,max cents,rms cents\n";
+
+    // the same grid either explicitly at fs * courant / lambdaMax or implicitly at fs
+    for (double fs : { 11025.0, 22050.0, 44100.0 })
+    {
+        for (double courant : courants)
+        {
+            double k = 1.0 / fs;
+            double kExplicit = k * parameters.getLambda() / courant;
+
+            Trombone trombone (parameters, kExplicit);
+            trombone.setEnergyInterval (std::numeric_limits<int>::max());
+            double explicitTime = measure (trombone, 1.0 / kExplicit) * 1e-6 / kExplicit;
+
+            ImplicitTrombone implicitTrombone (parameters, k, courant);
+            double implicitTime = measure (implicitTrombone, fs) * 1e-6 * fs;
+
+            Tube tube (parameters, kExplicit);
+            ImplicitTube implicitTube (parameters, k, courant);
+            double maxCents, rmsCents;
+            tuningError (measureResonances (tube, kExplicit, numResonances),
+                         measureResonances (implicitTube, k, numResonances), maxCents, rmsCents);
+
+            std::cout << String (fs, 0) << " Hz, lambda = " << String (implicitTube.getLambda(), 3) << " (theta = "
+                      << String (implicitTube.getTheta(), 3) << ", " << implicitTube.getN() + 1 << " points): "
+                      << String (implicitTime, 2) << " ms per s, explicit at " << String (1.0 / kExplicit, 0) << " Hz "
+                      << String (explicitTime, 2) << " ms per s, first " << numResonances << " resonances: max "
+                      << String (maxCents, 2) << " cents, rms " << String (rmsCents, 2) << " cents" << std::endl;
+            csv << String (fs, 0) << "," << implicitTube.getLambda() << "," << implicitTube.getTheta() << "," << implicitTube.getN() + 1 << ","
+                << 1.0 / kExplicit << "," << explicitTime << "," << implicitTime << "," << maxCents << "," << rmsCents << "\n";
+        }
+    }
+
+    if (args.containsOption ("--out"))
+    {
+        File outputFile = File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--out").unquoted());
+        if (!outputFile.replaceWithText (csv))
+        {
+            std::cout << "Could not write " << outputFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
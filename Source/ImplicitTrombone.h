@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    ImplicitTrombone.h
+    Created: 21 Oct 2026 4:12:51pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "ImplicitTube.h"
+#include "LipModel.h"
+
+//==============================================================================
+/*
+    Trombone with an ImplicitTube, coupled to the LipModel in the same way
+    (through the mouthpiece pressure as a function of the flow). The slide and
+    the temperature are fixed.
+
+    Usage: Trombone --benchmark-implicit [--courant=0.999,1.5,2,3,4] [--out=implicit.csv]
+    runs the same grid explicitly (Trombone at fs * courant / lambdaMax) and
+    with ImplicitTrombone at fs, and compares the cost per second of sound and
+    the first resonances of the tubes.
+*/
+class ImplicitTrombone
+{
+public:
+    ImplicitTrombone (const TromboneParameters& parameters, double k, double courant);
+    ~ImplicitTrombone();
+
+    void calculate();
+    float getOutput() { return tube->getOutput(); };
+    float getLipOutput() { return lipModel->getY(); };
+    void updateStates();
+
+    void refreshLipModelInputParams() { lipModel->refreshInputParams(); };
+    void setInputParams (double pressure, double lipFreq)
+    {
+        lipModel->setPressureVal (pressure);
+        lipModel->setLipFreqVal (lipFreq);
+    };
+    void setPressure (double pressure) { lipModel->setPressureVal (pressure); };
+    void setLipFrequency (double lipFreq) { lipModel->setLipFreqVal (lipFreq); };
+    double getL() { return tube->getL(); };
+
+    ImplicitTube& getTube() { return *tube; };
+
+    static int runFromCommandLine (const String& commandLine);
+
+private:
+    std::unique_ptr<ImplicitTube> tube;
+    std::unique_ptr<LipModel> lipModel;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ImplicitTrombone)
+};
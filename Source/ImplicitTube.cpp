@@ -0,0 +1,225 @@
+/*
+  ==============================================================================
+
+    ImplicitTube.cpp
+    Created: 21 Oct 2026 4:12:51pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ImplicitTube.h"
+#include "Tube.h"
+
+//==============================================================================
+ImplicitTube::ImplicitTube (const TromboneParameters& parameters, double k, double courant) : k (k)
+{
+    // the grid (and the geometry on it) of a Tube at the rate where its h is the one wanted here. The bell ends one
+    // grid point before the mouth, so sampling a finer grid would give another bore.
+    Tube grid (parameters, k * parameters.getLambda() / courant);
+    c = grid.getC();
+    rho = grid.getRho();
+    h = grid.getH();
+    N = grid.getNint();
+    L = N * h;
+
+    lambda = c * k / h;
+    lambdaOverRhoC = lambda / (rho * c);
+    rhoCLambda = rho * c * lambda;
+    theta = lambda > Global::lambdaMax ? 0.25 * (1.0 - Global::lambdaMax * Global::lambdaMax / (lambda * lambda)) : 0.0;
+
+    S.resize (N + 1);
+    for (int l = 0; l <= N; ++l)
+        S[l] = grid.getS (l);
+
+    // as Tube::calculateAreas()
+    SHalf.resize (N);
+    SBar.resize (N + 1);
+    for (int l = 0; l < N; ++l)
+        SHalf[l] = 0.5 * (S[l] + S[l+1]);
+    SBar[0] = S[0];
+    for (int l = 1; l < N; ++l)
+        SBar[l] = 0.5 * (SHalf[l-1] + SHalf[l]);
+    SBar[N] = S[N];
+
+    // the boundaries are half cells (hence the 2), their flow is the lip or the radiation
+    coeffLeft.assign (N + 1, 0);
+    coeffRight.assign (N + 1, 0);
+    for (int l = 1; l < N; ++l)
+    {
+        coeffLeft[l] = rhoCLambda * SHalf[l-1] / SBar[l];
+        coeffRight[l] = rhoCLambda * SHalf[l] / SBar[l];
+    }
+    coeffRight[0] = 2.0 * rhoCLambda * SHalf[0] / SBar[0];
+    coeffLeft[N] = 2.0 * rhoCLambda * SHalf[N-1] / SBar[N];
+
+    // radiation (as in Tube)
+    Tube::calculateRadiationCircuit (SBar[N], rho, c, k, R1, R2, Lr, Cr, z1, z2, z3, z4);
+
+    // rows of the system: sub[l] * p[l-1] + diag[l] * p[l] + super[l] * p[l+1]
+    double g = theta * lambdaOverRhoC;
+    std::vector<double> sub (N + 1), diag (N + 1), super (N + 1);
+    for (int l = 0; l <= N; ++l)
+    {
+        sub[l] = -g * coeffLeft[l];
+        super[l] = -g * coeffRight[l];
+        diag[l] = 1.0 + g * (coeffLeft[l] + coeffRight[l]);
+    }
+    diag[N] += rhoCLambda * z3;
+
+    // twisted factorisation
+    mid = N / 2;
+    topScale.assign (N + 1, 0);
+    topSub.assign (N + 1, 0);
+    topSuper.assign (N + 1, 0);
+    for (int i = 0; i < mid; ++i)
+    {
+        double den = diag[i] - (i > 0 ? sub[i] * topSuper[i-1] : 0.0);
+        topScale[i] = 1.0 / den;
+        topSub[i] = sub[i] / den;
+        topSuper[i] = super[i] / den;
+    }
+    bottomScale.assign (N + 1, 0);
+    bottomSuper.assign (N + 1, 0);
+    bottomSub.assign (N + 1, 0);
+    for (int i = N; i > mid; --i)
+    {
+        double den = diag[i] - (i < N ? super[i] * bottomSub[i+1] : 0.0);
+        bottomScale[i] = 1.0 / den;
+        bottomSuper[i] = super[i] / den;
+        bottomSub[i] = sub[i] / den;
+    }
+    double den = diag[mid] - sub[mid] * topSuper[mid-1] - super[mid] * bottomSub[mid+1];
+    midScale = 1.0 / den;
+    midSub = sub[mid] / den;
+    midSuper = super[mid] / den;
+
+    // the flow enters the first row as 2 * rho * c * lambda / SBar[0] * (Ub + Ur)
+    flowResponse.assign (N + 1, 0);
+    flowResponse[0] = 2.0 * rhoCLambda / SBar[0];
+    solve (flowResponse.data());
+
+    // LipModel's bCoeff = h * SBar0 / (rho * c^2 * k) needs to be 2 / flowResponse[0] (SBar[0] if theta is 0)
+    lipSBar = 2.0 * rho * c * c * k / (h * flowResponse[0]);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        pVecs[i].assign (N + 1, 0);
+        p[i] = pVecs[i].data();
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        vVecs[i].assign (N, 0);
+        v[i] = vVecs[i].data();
+    }
+    vTildeVec.assign (N, 0);
+    vTilde = vTildeVec.data();
+
+    resetStates();
+}
+
+ImplicitTube::~ImplicitTube()
+{
+}
+
+void ImplicitTube::solve (double* d)
+{
+    // explicit: only the radiation row has a coefficient
+    if (theta == 0)
+    {
+        d[N] *= bottomScale[N];
+        return;
+    }
+
+    int numTop = mid;
+    int numBottom = N - mid;
+
+    // elimination from both ends (two independent recursions)
+    d[0] *= topScale[0];
+    d[N] *= bottomScale[N];
+    for (int j = 1; j < numTop; ++j)
+    {
+        int t = j;
+        int b = N - j;
+        d[t] = topScale[t] * d[t] - topSub[t] * d[t-1];
+        d[b] = bottomScale[b] * d[b] - bottomSuper[b] * d[b+1];
+    }
+    for (int j = numTop; j < numBottom; ++j)
+    {
+        int b = N - j;
+        d[b] = bottomScale[b] * d[b] - bottomSuper[b] * d[b+1];
+    }
+
+    d[mid] = midScale * d[mid] - midSub * d[mid-1] - midSuper * d[mid+1];
+
+    // substitution towards both ends
+    for (int j = 1; j <= numTop; ++j)
+    {
+        int t = mid - j;
+        int b = mid + j;
+        d[t] -= topSuper[t] * d[t+1];
+        d[b] -= bottomSub[b] * d[b-1];
+    }
+    for (int j = numTop + 1; j <= numBottom; ++j)
+        d[mid + j] -= bottomSub[mid + j] * d[mid + j - 1];
+}
+
+void ImplicitTube::calculateVelocity()
+{
+    // the known part of v^{n+1/2}
+    for (int l = 0; l < N; ++l)
+        vTilde[l] = v[1][l] - lambdaOverRhoC * ((1.0 - 2.0 * theta) * (p[1][l+1] - p[1][l]) + theta * (p[2][l+1] - p[2][l]));
+
+    // right-hand side of the pressure update without the lip flow, solved in place
+    p[0][0] = p[1][0] - coeffRight[0] * vTilde[0];
+    for (int l = 1; l < N; ++l)
+        p[0][l] = p[1][l] - coeffRight[l] * vTilde[l] + coeffLeft[l] * vTilde[l-1];
+    p[0][N] = (1.0 - rhoCLambda * z3) * p[1][N] - 2.0 * rhoCLambda * (v1 + z4 * p1) + coeffLeft[N] * vTilde[N-1];
+
+    solve (p[0]);
+}
+
+void ImplicitTube::calculatePressure()
+{
+    double flow = Ub + Ur;
+    for (int l = 0; l <= N; ++l)
+        p[0][l] += flowResponse[l] * flow;
+
+    double g = theta * lambdaOverRhoC;
+    for (int l = 0; l < N; ++l)
+        v[0][l] = vTilde[l] - g * (p[0][l+1] - p[0][l]);
+}
+
+void ImplicitTube::calculateRadiation()
+{
+    v1Next = v1 + k / (2.0 * Lr) * (p[0][N] + p[1][N]);
+    p1Next = z1 * 0.5 * (p[0][N] + p[1][N]) + z2 * p1;
+}
+
+void ImplicitTube::updateStates()
+{
+    double* pTmp = p[2];
+    p[2] = p[1];
+    p[1] = p[0];
+    p[0] = pTmp;
+
+    double* vTmp = v[1];
+    v[1] = v[0];
+    v[0] = vTmp;
+
+    p1 = p1Next;
+    v1 = v1Next;
+}
+
+void ImplicitTube::resetStates()
+{
+    for (auto& vec : pVecs)
+        std::fill (vec.begin(), vec.end(), 0.0);
+    for (auto& vec : vVecs)
+        std::fill (vec.begin(), vec.end(), 0.0);
+    std::fill (vTildeVec.begin(), vTildeVec.end(), 0.0);
+    p1 = p1Next = v1 = v1Next = 0;
+    Ub = 0;
+    Ur = 0;
+}
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    ImplicitTube.h
+    Created: 21 Oct 2026 4:12:51pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "TromboneParameters.h"
+
+//==============================================================================
+/*
+    Tube with a (semi-)implicit scheme, so that the grid spacing h doesn't
+    need to be c * k: the Courant number lambda = c * k / h can be larger
+    than 1 (a finer grid than Tube at the same rate, or the same grid at a
+    lower rate).
+
+    The velocity update uses the pressure averaged over three time steps,
+        v^{n+1/2} = v^{n-1/2} - lambda / (rho * c) * D+ (theta * p^{n+1} + (1 - 2 * theta) * p^n + theta * p^{n-1}),
+    and the pressure update is the one of Tube. Substituting the velocity
+    gives a tridiagonal system for p^{n+1} (also at the lip and radiation
+    boundaries), which is stable for theta >= (1 - 1 / lambda^2) / 4. Theta is
+    the smallest value for which the highest wavenumber has the same margin as
+    Tube (lambda = Global::lambdaMax), so up to lambdaMax theta is 0 and the
+    scheme is the explicit one.
+
+    The matrix only depends on the geometry, so it is factorised once (from
+    both ends towards the middle). Per sample the two substitutions run from
+    both ends at the same time: a recursion doesn't vectorise, but the two
+    independent chains halve its latency. The flow at the lip only enters the
+    first row, so the system is solved without it and the response to the
+    flow (precomputed) is added afterwards. That gives the lip model the
+    mouthpiece pressure as a linear function of the flow, as in Tube.
+
+    The grid and geometry are those of a Tube at the rate k * lambda / courant
+    (lambda of TromboneParameters::getLambda(); a whole number of intervals,
+    so at the length of the slide in the parameters rounded to the grid). At
+    courant = lambdaMax the two schemes are the same. The slide and the temperature are fixed.
+
+    Order per sample: calculateVelocity() (the explicit part and the solve
+    without flow), setFlowVelocities(), calculatePressure() and
+    calculateRadiation(), as Tube.
+*/
+class ImplicitTube
+{
+public:
+    // courant is the target lambda = c * k / h
+    ImplicitTube (const TromboneParameters& parameters, double k, double courant);
+    ~ImplicitTube();
+
+    void calculateVelocity();
+    void setFlowVelocities (double UbIn, double UrIn)
+    {
+        Ub = UbIn;
+        Ur = UrIn;
+    };
+    void calculatePressure();
+    void calculateRadiation();
+    void updateStates();
+    void resetStates();
+
+    // two points before the end of the bell (as Tube::getOutput())
+    float getOutput() { return p[1][N - 2]; };
+
+    double getP (int n, int l) { return p[n][l]; };
+    double getV (int n, int l) { return v[n][l]; };
+
+    // for LipModel, which solves the flow together with (p0^{n+1} + p0^n) / 2 = pHat + Utot / bCoeff:
+    // pHat after calculateVelocity(), and the SBar0 that gives bCoeff
+    double getLipPressure() { return 0.5 * (p[0][0] + p[1][0]); };
+    double getLipSBar() { return lipSBar; };
+    double getSHalf (int idx) { return SHalf[idx]; };
+
+    double getH() { return h; };
+    double getRho() { return rho; };
+    double getC() { return c; };
+    double getL() { return L; };
+    double getLambda() { return lambda; };
+    double getTheta() { return theta; };
+    int getN() { return N; };
+
+private:
+    // solves A x = d in place (the factorisation is in top / bottom)
+    void solve (double* d);
+
+    double k, h, c, rho, L, lambda, theta;
+    double lambdaOverRhoC, rhoCLambda;
+    int N;      // number of intervals (N + 1 pressure points)
+
+    std::vector<double> S, SHalf, SBar;
+
+    // the pressure update coefficients of the velocities: rhoCLambda * SHalf / SBar on either side of a point
+    std::vector<double> coeffLeft, coeffRight;
+
+    // twisted factorisation of the tridiagonal matrix: rows 0 to mid - 1 are eliminated downwards, rows N to mid + 1 upwards
+    int mid;
+    std::vector<double> topScale, topSub, topSuper;        // d'[i] = topScale[i] * d[i] - topSub[i] * d'[i-1], x[i] = d'[i] - topSuper[i] * x[i+1]
+    std::vector<double> bottomScale, bottomSuper, bottomSub;
+    double midScale, midSub, midSuper;
+
+    // response of p^{n+1} to a unit total lip flow
+    std::vector<double> flowResponse;
+    double lipSBar;
+
+    std::vector<double> pVecs[3], vVecs[2], vTildeVec;
+    double* p[3];   // n + 1, n and n - 1
+    double* v[2];   // n + 1/2 and n - 1/2
+    double* vTilde; // the explicit part of v^{n+1/2}
+
+    double Ub = 0, Ur = 0;
+
+    // radiation (as in Tube)
+    double R1, Lr, R2, Cr, z1, z2, z3, z4;
+    double p1Next, p1, v1Next, v1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ImplicitTube)
+};
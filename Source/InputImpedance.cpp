@@ -0,0 +1,388 @@
+/*
+  ==============================================================================
+
+    InputImpedance.cpp
+    Created: 19 Oct 2026 10:02:37pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "InputImpedance.h"
+#include "Tube.h"
+#include <complex>
+
+//==============================================================================
+// Z <- (a Z + j bi) / (j ci Z + d) for every wave number k, with the transfer matrix [a, j bi; j ci, d] of the segment.
+// cs and sn are cos (k * length) and sin (k * length), the loops don't depend on earlier iterations so they vectorise.
+static void propagate (const double* k, const double* oOK, const double* cs, const double* sn, double* zRe, double* zIm, int num,
+                       double S1, double S2, double x1, double x2, double rho, double c)
+{
+    if (x1 == 0)
+    {
+        // cylinder
+        double Zc = rho * c / S1;
+        double oOZc = 1.0 / Zc;
+        for (int i = 0; i < num; ++i)
+        {
+            double bi = Zc * sn[i];
+            double ci = sn[i] * oOZc;
+
+            double numRe = cs[i] * zRe[i];
+            double numIm = cs[i] * zIm[i] + bi;
+            double denRe = cs[i] - ci * zIm[i];
+            double denIm = ci * zRe[i];
+            double oODen = 1.0 / (denRe * denRe + denIm * denIm);
+            zRe[i] = (numRe * denRe + numIm * denIm) * oODen;
+            zIm[i] = (numIm * denRe - numRe * denIm) * oODen;
+        }
+    }
+    else
+    {
+        // cone: x * p satisfies the 1D wave equation, so propagate (x p, d(x p)/dx) as in a cylinder
+        double oOX1 = 1.0 / x1;
+        double x2OverX1 = x2 * oOX1;
+        double betaOverK = rho * c * x2 / S2;
+        double gammaK = S1 * oOX1 / (rho * c);
+        for (int i = 0; i < num; ++i)
+        {
+            double snOverKX1 = sn[i] * oOX1 * oOK[i];
+            double beta = k[i] * betaOverK;
+            double gamma = gammaK * oOK[i];
+
+            double a = cs[i] * x2OverX1 - snOverKX1;
+            double bi = snOverKX1 * beta;
+            double ci = -gamma * (a - k[i] * sn[i] * x2 - cs[i]);
+            double d = gamma * beta * (snOverKX1 + cs[i]);
+
+            double numRe = a * zRe[i];
+            double numIm = a * zIm[i] + bi;
+            double denRe = d - ci * zIm[i];
+            double denIm = ci * zRe[i];
+            double oODen = 1.0 / (denRe * denRe + denIm * denIm);
+            zRe[i] = (numRe * denRe + numIm * denIm) * oODen;
+            zIm[i] = (numIm * denRe - numRe * denIm) * oODen;
+        }
+    }
+}
+
+//==============================================================================
+InputImpedance::InputImpedance (const TromboneParameters& parameters, int numThreads) : parameters (parameters),
+                                                                                         pool (numThreads)
+{
+    c = Tube::calculateSpeedOfSound (parameters.T);
+    rho = Tube::calculateDensity (parameters.T);
+
+    setFrequencies (20.0, 2000.0, 4096);
+
+    for (int i = 0; i < 7; ++i)
+        slideLengths.push_back (std::min (parameters.LnonExtended * pow (2.0, i / 12.0), parameters.getLmax()));
+}
+
+InputImpedance::~InputImpedance()
+{
+}
+
+void InputImpedance::setFrequencies (double fMin, double fMax, int numFrequencies)
+{
+    jassert (fMin > 0 && fMax > fMin && numFrequencies > 1);
+    frequencies.resize (numFrequencies);
+    for (int i = 0; i < numFrequencies; ++i)
+        frequencies[i] = Global::linspace (fMin, fMax, numFrequencies, i);
+}
+
+void InputImpedance::calculateSegments (double L, std::vector<Segment>& segments)
+{
+    auto& geometry = parameters.geometry;
+    double totLength = 0;
+    for (int i = 0; i < TromboneParameters::numSections; ++i)
+        totLength += geometry[0][i];
+
+    // as in Tube::calculateGeometry the sections are scaled to LnonExtended and the slide takes the extension
+    double scale = parameters.LnonExtended / totLength;
+
+    auto addCone = [&segments] (double length, double r1, double r2) {
+        if (r1 == r2)
+        {
+            segments.push_back ({ length, r1 * r1 * double_Pi, r2 * r2 * double_Pi, 0, 0 });
+            return;
+        }
+        double x1 = r1 * length / (r2 - r1);
+        segments.push_back ({ length, r1 * r1 * double_Pi, r2 * r2 * double_Pi, x1, x1 + length });
+    };
+
+    segments.clear();
+    for (int i = 0; i < 4; ++i)
+        addCone (geometry[0][i] * scale + (i == 1 ? L - parameters.LnonExtended : 0), geometry[1][i], geometry[1][i]);
+
+    // tuning slide
+    addCone (geometry[0][4] * scale, geometry[1][4], geometry[1][5]);
+
+    // bell: the radius b * (x + x0)^-flare goes from x = length to 0. Equal steps in log (x + x0) give
+    // the same change in radius per segment, so the segments are shortest at the mouth.
+    double bellLength = geometry[0][5];
+    auto bellRadius = [this] (double x) { return parameters.b * pow (x + parameters.x0, -parameters.flare); };
+    double logStart = log (bellLength + parameters.x0);
+    double logEnd = log (parameters.x0);
+    double xPrev = bellLength;
+    for (int j = 1; j <= numBellSegments; ++j)
+    {
+        double x = j == numBellSegments ? 0 : exp (logStart + (logEnd - logStart) * j / numBellSegments) - parameters.x0;
+        addCone ((xPrev - x) * scale, bellRadius (xPrev), bellRadius (x));
+        xPrev = x;
+    }
+}
+
+void InputImpedance::calculateRadiationImpedance (double omega, double SEnd, double& re, double& im)
+{
+    double R1, R2, Lr, Cr;
+    Tube::calculateRadiationCircuit (SEnd, rho, c, R1, R2, Lr, Cr);
+
+    // specific impedance of the circuit, divided by the area for the acoustic impedance
+    std::complex<double> j (0, 1);
+    std::complex<double> admittance = 1.0 / (j * omega * Lr) + 1.0 / (R1 + R2 / (1.0 + j * omega * R2 * Cr));
+    std::complex<double> Z = 1.0 / (admittance * SEnd);
+    re = Z.real();
+    im = Z.imag();
+}
+
+void InputImpedance::calculateMagnitudes (int position, int startIdx, int endIdx, Scratch& scratch)
+{
+    auto& segments = bores[position];
+    int num = endIdx - startIdx;
+
+    for (int i = 0; i < num; ++i)
+    {
+        double omega = 2.0 * double_Pi * frequencies[startIdx + i];
+        scratch.k[i] = omega / c;
+        scratch.oOK[i] = 1.0 / scratch.k[i];
+        calculateRadiationImpedance (omega, segments.back().S2, scratch.zRe[i], scratch.zIm[i]);
+    }
+
+    // the frequencies are equally spaced, so cos and sin of k * length follow from rotating by the step
+    // (much cheaper than calling cos and sin for every frequency and segment)
+    double dK = num > 1 ? scratch.k[1] - scratch.k[0] : 0;
+    for (int s = static_cast<int> (segments.size()) - 1; s >= 0; --s)
+    {
+        auto& segment = segments[s];
+        double cosStep = cos (dK * segment.length);
+        double sinStep = sin (dK * segment.length);
+        scratch.cs[0] = cos (scratch.k[0] * segment.length);
+        scratch.sn[0] = sin (scratch.k[0] * segment.length);
+        for (int i = 1; i < num; ++i)
+        {
+            scratch.cs[i] = scratch.cs[i-1] * cosStep - scratch.sn[i-1] * sinStep;
+            scratch.sn[i] = scratch.sn[i-1] * cosStep + scratch.cs[i-1] * sinStep;
+        }
+
+        propagate (scratch.k.data(), scratch.oOK.data(), scratch.cs.data(), scratch.sn.data(), scratch.zRe.data(), scratch.zIm.data(), num,
+                   segment.S1, segment.S2, segment.x1, segment.x2, rho, c);
+    }
+
+    for (int i = 0; i < num; ++i)
+        magnitudes[position][startIdx + i] = sqrt (scratch.zRe[i] * scratch.zRe[i] + scratch.zIm[i] * scratch.zIm[i]);
+}
+
+double InputImpedance::calculateMagnitude (int position, double freq)
+{
+    auto& segments = bores[position];
+    double omega = 2.0 * double_Pi * freq;
+    double k = omega / c;
+    double oOK = 1.0 / k;
+    double zRe, zIm;
+    calculateRadiationImpedance (omega, segments.back().S2, zRe, zIm);
+
+    for (int s = static_cast<int> (segments.size()) - 1; s >= 0; --s)
+    {
+        auto& segment = segments[s];
+        double cs = cos (k * segment.length);
+        double sn = sin (k * segment.length);
+        propagate (&k, &oOK, &cs, &sn, &zRe, &zIm, 1, segment.S1, segment.S2, segment.x1, segment.x2, rho, c);
+    }
+    return sqrt (zRe * zRe + zIm * zIm);
+}
+
+// Near a resonance Z ~ Zpeak / (1 + 2jQ (f - f0) / f0), so 1 / |Z|^2 is a parabola in f with its minimum at f0
+// and twice its minimum at the half-power frequencies f0 +- f0 / 2Q. Returns false if the points don't fit one.
+// If the points are much further apart than the bandwidth, the minimum is lost in rounding and halfBandwidth is 0.
+static bool fitResonance (const double* f, const double* magnitude, double& f0, double& peak, double& halfBandwidth)
+{
+    double y[3];
+    for (int i = 0; i < 3; ++i)
+        y[i] = 1.0 / (magnitude[i] * magnitude[i]);
+
+    // y = A (f - f0)^2 + B through the three points
+    double d01 = (y[1] - y[0]) / (f[1] - f[0]);
+    double d12 = (y[2] - y[1]) / (f[2] - f[1]);
+    double A = (d12 - d01) / (f[2] - f[0]);
+    if (!(A > 0))
+        return false;
+
+    f0 = 0.5 * (f[0] + f[1]) - 0.5 * d01 / A;
+    double B = y[1] - A * (f[1] - f0) * (f[1] - f0);
+    peak = B > 0 ? 1.0 / sqrt (B) : 0;
+    halfBandwidth = B > 0 ? sqrt (B / A) : 0;
+    return true;
+}
+
+void InputImpedance::findResonances (int position)
+{
+    auto& magnitude = magnitudes[position];
+    auto& result = resonances[position];
+    result.clear();
+
+    int numFrequencies = static_cast<int> (frequencies.size());
+    double df = frequencies[1] - frequencies[0];
+    for (int i = 1; i < numFrequencies - 1; ++i)
+    {
+        if (!(magnitude[i] > magnitude[i-1] && magnitude[i] >= magnitude[i+1]))
+            continue;
+
+        // first fit through the bins around the peak, then refit through the estimated peak and half-power
+        // frequencies (where the single mode approximation is most accurate) until it converges
+        double f0, peak, halfBandwidth;
+        if (!fitResonance (&frequencies[i-1], &magnitude[i-1], f0, peak, halfBandwidth))
+            continue;
+
+        double spacing = halfBandwidth > 0 ? halfBandwidth : 0.01 * df;
+        bool converged = false;
+        for (int r = 0; r < maxRefits && !converged; ++r)
+        {
+            double f[3] = { f0 - spacing, f0, f0 + spacing };
+            double m[3];
+            for (int j = 0; j < 3; ++j)
+                m[j] = calculateMagnitude (position, f[j]);
+
+            double previousF0 = f0;
+            if (!fitResonance (f, m, f0, peak, halfBandwidth))
+                break;
+
+            // the bandwidth is still below the spacing: zoom in
+            if (halfBandwidth == 0)
+            {
+                spacing *= 0.01;
+                continue;
+            }
+            converged = std::abs (halfBandwidth - spacing) < 1e-3 * halfBandwidth && std::abs (f0 - previousF0) < 1e-3 * halfBandwidth;
+            spacing = halfBandwidth;
+        }
+
+        if (halfBandwidth > 0)
+            result.push_back ({ f0, peak, f0 / (2.0 * halfBandwidth) });
+    }
+}
+
+void InputImpedance::calculate()
+{
+    double startTime = Time::getMillisecondCounterHiRes();
+
+    int numPositions = getNumSlidePositions();
+    int numFrequencies = static_cast<int> (frequencies.size());
+
+    bores.resize (numPositions);
+    magnitudes.resize (numPositions);
+    resonances.resize (numPositions);
+    for (int p = 0; p < numPositions; ++p)
+    {
+        calculateSegments (slideLengths[p], bores[p]);
+        magnitudes[p].resize (numFrequencies);
+    }
+
+    // the spectra first, as the resonances are found from them
+    jobs.clear();
+    for (int p = 0; p < numPositions; ++p)
+        for (int start = 0; start < numFrequencies; start += frequenciesPerJob)
+            jobs.push_back (std::make_unique<Job> (*this, p, start, std::min (start + frequenciesPerJob, numFrequencies)));
+
+    for (auto& job : jobs)
+        pool.addJob (job.get(), false);
+    for (auto& job : jobs)
+        pool.waitForJobToFinish (job.get(), -1);
+
+    jobs.clear();
+    for (int p = 0; p < numPositions; ++p)
+        jobs.push_back (std::make_unique<Job> (*this, p, 0, 0));
+
+    for (auto& job : jobs)
+        pool.addJob (job.get(), false);
+    for (auto& job : jobs)
+        pool.waitForJobToFinish (job.get(), -1);
+    jobs.clear();
+
+    calculationTime = (Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+}
+
+int InputImpedance::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+    double fMin = args.containsOption ("--fmin") ? args.getValueForOption ("--fmin").getDoubleValue() : 20.0;
+    double fMax = args.containsOption ("--fmax") ? args.getValueForOption ("--fmax").getDoubleValue() : 2000.0;
+    int numFrequencies = args.containsOption ("--num") ? args.getValueForOption ("--num").getIntValue() : 4096;
+    int numThreads = args.containsOption ("--threads") ? args.getValueForOption ("--threads").getIntValue() : SystemStats::getNumCpus();
+
+    if (!(fMin > 0) || !(fMax > fMin) || numFrequencies < 2 || numThreads < 1)
+    {
+        std::cout << "Invalid frequency range or number of threads" << std::endl;
+        return 1;
+    }
+
+    InputImpedance impedance (TromboneParameters(), numThreads);
+    impedance.setFrequencies (fMin, fMax, numFrequencies);
+    impedance.calculate();
+
+    for (int p = 0; p < impedance.getNumSlidePositions(); ++p)
+    {
+        std::cout << "Position " << p + 1 << " (L = " << impedance.getSlideLength (p) << " m):" << std::endl;
+        for (auto& resonance : impedance.getResonances (p))
+            std::cout << "    " << resonance.frequency << " Hz, Q = " << resonance.Q << std::endl;
+    }
+    std::cout << "Calculated " << numFrequencies << " frequencies at " << impedance.getNumSlidePositions() << " slide positions in "
+              << impedance.getCalculationTime() * 1000.0 << " ms (" << numThreads << " threads)" << std::endl;
+
+    if (args.containsOption ("--out"))
+    {
+        File outputFile = File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--out").unquoted());
+        String text = "f";
+        for (int p = 0; p < impedance.getNumSlidePositions(); ++p)
+            text << ",L=" << String (impedance.getSlideLength (p), 4);
+        text << "\n";
+
+        for (int i = 0; i < numFrequencies; ++i)
+        {
+            text << String (impedance.getFrequencies()[i], 4);
+            for (int p = 0; p < impedance.getNumSlidePositions(); ++p)
+                text << "," << String (impedance.getMagnitude (p)[i], 6);
+            text << "\n";
+        }
+
+        if (!outputFile.replaceWithText (text))
+        {
+            std::cout << "Could not write " << outputFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//==============================================================================
+InputImpedance::Job::Job (InputImpedance& impedance, int position, int startIdx, int endIdx) : ThreadPoolJob ("Trombone impedance"),
+                                                                                                impedance (impedance),
+                                                                                                position (position),
+                                                                                                startIdx (startIdx),
+                                                                                                endIdx (endIdx)
+{
+    int num = endIdx - startIdx;
+    for (auto* v : { &scratch.k, &scratch.oOK, &scratch.cs, &scratch.sn, &scratch.zRe, &scratch.zIm })
+        v->resize (num);
+}
+
+ThreadPoolJob::JobStatus InputImpedance::Job::runJob()
+{
+    // jobs without a frequency range find the resonances of their slide position
+    if (endIdx > startIdx)
+        impedance.calculateMagnitudes (position, startIdx, endIdx, scratch);
+    else
+        impedance.findResonances (position);
+    return jobHasFinished;
+}
@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    InputImpedance.h
+    Created: 19 Oct 2026 10:02:37pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "TromboneParameters.h"
+
+//==============================================================================
+/*
+    Input impedance of the bore in the frequency domain (transfer matrices), to
+    check the tuning of a geometry without running the simulation.
+
+    The bore is the one of Tube::calculateGeometry: the cylindrical sections, the
+    slide (section 1, extended by L - LnonExtended), the tuning slide as a cone
+    and the bell formula b * (x + x0)^-flare, here as a chain of cones. The load
+    is the radiation circuit of Tube (Lr parallel to R1 in series with R2 || Cr).
+    Like the simulation the tube itself is lossless, so the Q values only come
+    from radiation. The simulated grid ends the bell one grid point before the
+    mouth and has numerical dispersion, so its resonances can deviate slightly.
+
+    All slide positions and frequencies are evaluated at once, split into jobs
+    over (slide position, frequency range) on a thread pool. The inner loops run
+    over frequencies so they vectorise. The frequency, magnitude and Q of every
+    peak of |Z| is then refined by fitting a single mode to a few evaluations
+    around it, so the frequency grid can be much coarser than the bandwidths.
+
+    Usage: Trombone --impedance [--fmin=20] [--fmax=2000] [--num=4096] [--threads=N] [--out=impedance.csv]
+*/
+class InputImpedance
+{
+public:
+    struct Resonance
+    {
+        double frequency;   // [Hz]
+        double magnitude;   // |Z| at the peak [Pa s m^-3]
+        double Q;           // frequency / half-power bandwidth
+    };
+
+    InputImpedance (const TromboneParameters& parameters, int numThreads);
+    ~InputImpedance();
+
+    // linearly spaced frequencies (fMin > 0)
+    void setFrequencies (double fMin, double fMax, int numFrequencies);
+
+    // by default the seven slide positions (each a semitone lower)
+    void setSlideLengths (const std::vector<double>& lengths) { slideLengths = lengths; };
+
+    void calculate();
+
+    int getNumSlidePositions() { return static_cast<int> (slideLengths.size()); };
+    double getSlideLength (int position) { return slideLengths[position]; };
+    const std::vector<double>& getFrequencies() { return frequencies; };
+    const std::vector<double>& getMagnitude (int position) { return magnitudes[position]; };
+    const std::vector<Resonance>& getResonances (int position) { return resonances[position]; };
+
+    double getCalculationTime() { return calculationTime; };
+
+    static int runFromCommandLine (const String& commandLine);
+
+    int numBellSegments = 48;
+    int frequenciesPerJob = 1024;
+    int maxRefits = 10;
+
+private:
+    // truncated cone (a cylinder if x1 is 0) between two points of the bore
+    struct Segment
+    {
+        double length, S1, S2;
+        double x1, x2;      // signed distance of both ends to the apex
+    };
+
+    struct Scratch
+    {
+        std::vector<double> k, oOK, cs, sn, zRe, zIm;
+    };
+
+    class Job : public ThreadPoolJob
+    {
+    public:
+        Job (InputImpedance& impedance, int position, int startIdx, int endIdx);
+        JobStatus runJob() override;
+
+    private:
+        InputImpedance& impedance;
+        int position, startIdx, endIdx;
+        Scratch scratch;
+    };
+
+    void calculateSegments (double L, std::vector<Segment>& segments);
+    void calculateRadiationImpedance (double omega, double SEnd, double& re, double& im);
+
+    // evaluates the frequencies in [startIdx, endIdx) into magnitudes[position]
+    void calculateMagnitudes (int position, int startIdx, int endIdx, Scratch& scratch);
+    double calculateMagnitude (int position, double freq);
+    void findResonances (int position);
+
+    TromboneParameters parameters;
+    double c, rho;
+
+    std::vector<double> frequencies;
+    std::vector<double> slideLengths;
+
+    std::vector<std::vector<Segment>> bores;
+    std::vector<std::vector<double>> magnitudes;
+    std::vector<std::vector<Resonance>> resonances;
+
+    ThreadPool pool;
+    std::vector<std::unique_ptr<Job>> jobs;
+    double calculationTime = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InputImpedance)
+};
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    JunctionInterpolator.cpp
+    Created: 19 Oct 2026 5:12:30pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "JunctionInterpolator.h"
+#include "Tube.h"
+
+//==============================================================================
+JunctionInterpolatorBenchmark::JunctionInterpolatorBenchmark (double fs) : fs (fs)
+{
+    TromboneParameters defaultParameters;
+    h = Tube::calculateSpeedOfSound (defaultParameters.T) / (fs * Global::lambdaMax);
+    L = defaultParameters.L;
+}
+
+template <class Interpolator>
+JunctionInterpolatorBenchmark::Result JunctionInterpolatorBenchmark::run()
+{
+    Result result;
+    result.name = String (Interpolator::getName()) + " (" + String (Interpolator::numOwn + Interpolator::numOther) + " points)";
+
+    double own[Interpolator::numOwn];
+    double other[Interpolator::numOther];
+
+    //// error ////
+    // a wave exp (i * kappa * x) sampled at the grid points, interpolated at x = 1
+    for (auto f : frequencies)
+    {
+        double kappa = 2.0 * double_Pi * f * h / Tube::calculateSpeedOfSound (TromboneParameters().T); // per grid unit
+        double magErr = 0;
+        double phaseErr = 0;
+        for (int a = 0; a < numAlfs; ++a)
+        {
+            double alf = a / static_cast<double> (numAlfs);
+            Interpolator::calculateCoefficients (alf, own, other);
+
+            std::complex<double> H = 0;
+            for (int j = 0; j < Interpolator::numOwn; ++j)
+                H += own[j] * std::exp (std::complex<double> (0, -kappa * j));
+            for (int j = 0; j < Interpolator::numOther; ++j)
+                H += other[j] * std::exp (std::complex<double> (0, kappa * (alf + j)));
+
+            H *= std::exp (std::complex<double> (0, -kappa));
+            magErr += Decibels::gainToDecibels (std::abs (H), -200.0);
+            phaseErr += std::arg (H);
+        }
+        magErr /= numAlfs;
+        phaseErr /= numAlfs;
+        result.magnitudeError.push_back (magErr);
+        result.phaseError.push_back (phaseErr);
+
+        // the phase error shifts the junction by phaseErr / kappa grid points (passed twice per round trip)
+        double deltaL = phaseErr / kappa * h;
+        result.tuningError.push_back (-1200.0 * log2 (1.0 + deltaL / L));
+    }
+
+    //// cost ////
+    const int bufferSize = 4096;
+    const int mask = bufferSize - 1;
+    std::vector<double> u (bufferSize + Interpolator::numOwn + Interpolator::numOther);
+    Random random (1234);
+    for (auto& val : u)
+        val = random.nextDouble() - 0.5;
+
+    auto timeLoop = [&] (bool moving) {
+        double sum = 0;
+        double alf = 0.5;
+        Interpolator::calculateCoefficients (alf, own, other);
+        double startTime = Time::getMillisecondCounterHiRes();
+        for (int n = 0; n < numBenchmarkSamples; ++n)
+        {
+            if (moving)
+            {
+                alf = alf >= 0.999 ? 0.0 : alf + 1e-3;
+                Interpolator::calculateCoefficients (alf, own, other);
+            }
+            const double* left = &u[(n & mask) + Interpolator::numOwn]; // u_M
+            const double* right = left + 1;                           // w_0
+            // as Tube::calculateVelocity()
+            double upMP1 = 0;
+            double wpm1 = 0;
+            for (int j = Interpolator::numOwn - 1; j >= 0; --j)
+                upMP1 += own[j] * left[-j];
+            for (int j = 0; j < Interpolator::numOther; ++j)
+                upMP1 += other[j] * right[j];
+            for (int j = Interpolator::numOther - 1; j >= 0; --j)
+                wpm1 += other[j] * left[-j];
+            for (int j = 0; j < Interpolator::numOwn; ++j)
+                wpm1 += own[j] * right[j];
+            sum += upMP1 - wpm1;
+        }
+        double nsPerSample = (Time::getMillisecondCounterHiRes() - startTime) * 1e6 / numBenchmarkSamples;
+        checksum += sum; // so that the loop isn't optimised away
+        return nsPerSample;
+    };
+    result.nsPerSample = timeLoop (false);
+    result.nsPerSampleMoving = timeLoop (true);
+    return result;
+}
+
+std::vector<JunctionInterpolatorBenchmark::Result> JunctionInterpolatorBenchmark::runAll()
+{
+    return { run<QuadraticInterpolator>(),
+             run<CubicLagrangeInterpolator>(),
+             run<WindowedSincInterpolator<2>>(),
+             run<WindowedSincInterpolator<4>>() };
+}
+
+int JunctionInterpolatorBenchmark::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+    double fs = args.containsOption ("--fs") ? args.getValueForOption ("--fs").getDoubleValue() : 44100.0;
+    if (!(fs > 0))
+    {
+        std::cout << "Invalid sample rate" << std::endl;
+        return 1;
+    }
+
+    JunctionInterpolatorBenchmark benchmark (fs);
+    auto results = benchmark.runAll();
+
+    std::cout << "Junction interpolators at fs = " << fs << " Hz (active: " << JunctionInterpolator::getName() << ")" << std::endl;
+    for (auto& result : results)
+    {
+        std::cout << std::endl << result.name << ": "
+                  << result.nsPerSample << " ns/sample cached, "
+                  << result.nsPerSampleMoving << " ns/sample moving" << std::endl;
+        for (size_t i = 0; i < benchmark.frequencies.size(); ++i)
+            std::cout << "    " << benchmark.frequencies[i] << " Hz: magnitude " << result.magnitudeError[i]
+                      << " dB, phase " << result.phaseError[i] << " rad, tuning " << result.tuningError[i] << " cents" << std::endl;
+    }
+    return 0;
+}
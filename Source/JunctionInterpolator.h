@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    JunctionInterpolator.h
+    Created: 19 Oct 2026 5:12:30pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+
+//==============================================================================
+/*
+    Interpolators for the virtual points at the junction between the left (u)
+    and right (w) system of the dynamic grid. With alf = N - Nint, the grid
+    points around the junction are at (in grid units, relative to u_M)
+
+        ..., u_{M-1}: -1, u_M: 0, w_0: alf, w_1: alf + 1, ...
+
+    and the virtual point u_{M+1} is at 1. Mirrored around the junction, w_{-1}
+    is found in the same way, so the weights are split in "own" points (0, -1, ...)
+    and "other" points (alf, alf + 1, ...):
+
+        upMP1 = sum_j own[j] * u_{M-j} + sum_j other[j] * w_j
+        wpm1  = sum_j own[j] * w_j     + sum_j other[j] * u_{M-j}
+
+    The interpolator is chosen at compile time by defining TROMBONE_JUNCTION_INTERPOLATOR
+    (QuadraticInterpolator by default). See JunctionInterpolatorBenchmark for their cost
+    and their error at the junction.
+*/
+
+// quadratic Lagrange through u_M, w_0 and w_1 (as in Harrison-Harsley & Bilbao)
+struct QuadraticInterpolator
+{
+    static const int numOwn = 1;
+    static const int numOther = 2;
+    static const char* getName() { return "quadratic"; };
+
+    static void calculateCoefficients (double alf, double* own, double* other)
+    {
+        own[0] = (alf - 1) / (alf + 1);
+        other[0] = 1;
+        other[1] = -(alf - 1) / (alf + 1);
+    }
+};
+
+// cubic Lagrange through u_M, w_0, w_1 and w_2. Using u_{M-1} and u_M instead (symmetric around
+// the junction) makes the scheme unstable for 0 < alf < 1.
+struct CubicLagrangeInterpolator
+{
+    static const int numOwn = 1;
+    static const int numOther = 3;
+    static const char* getName() { return "cubic Lagrange"; };
+
+    static void calculateCoefficients (double alf, double* own, double* other)
+    {
+        own[0] = (alf - 1) / (alf + 2);
+        other[0] = (alf + 1) * 0.5;
+        other[1] = 1 - alf;
+        other[2] = -alf * (1 - alf) / (2.0 * (alf + 2));
+    }
+};
+
+// Hann-windowed sinc over halfWidth points on each side, normalised to unity gain at DC.
+// Not energy conserving, so only stable for moderate slide speeds (the watchdog catches the rest).
+template <int halfWidth>
+struct WindowedSincInterpolator
+{
+    static const int numOwn = halfWidth;
+    static const int numOther = halfWidth;
+    static const char* getName() { return "windowed sinc"; };
+
+    static void calculateCoefficients (double alf, double* own, double* other)
+    {
+        double sum = 0;
+        for (int j = 0; j < halfWidth; ++j)
+        {
+            own[j] = weight (1.0 + j);
+            other[j] = weight (1.0 - alf - j);
+            sum += own[j] + other[j];
+        }
+        double oOSum = 1.0 / sum;
+        for (int j = 0; j < halfWidth; ++j)
+        {
+            own[j] *= oOSum;
+            other[j] *= oOSum;
+        }
+    }
+
+    // distance d from the virtual point (window is zero at halfWidth + 1, so all points contribute)
+    static double weight (double d)
+    {
+        double sinc = std::abs (d) < 1e-12 ? 1.0 : sin (double_Pi * d) / (double_Pi * d);
+        return sinc * 0.5 * (1.0 + cos (double_Pi * d / (halfWidth + 1)));
+    }
+};
+
+#ifndef TROMBONE_JUNCTION_INTERPOLATOR
+ #define TROMBONE_JUNCTION_INTERPOLATOR QuadraticInterpolator
+#endif
+
+using JunctionInterpolator = TROMBONE_JUNCTION_INTERPOLATOR;
+
+//==============================================================================
+/*
+    Compares the interpolators: cost per sample (with cached coefficients and
+    when the coefficients are recalculated every sample while the slide moves)
+    and the error of the interpolated virtual point for a travelling wave at
+    different frequencies, averaged over alf. The phase error is also expressed
+    as the tuning error it would cause for the default tube.
+
+    Usage: Trombone --benchmark-junction [--fs=44100]
+*/
+class JunctionInterpolatorBenchmark
+{
+public:
+    struct Result
+    {
+        String name;
+        double nsPerSample;         // coefficients cached
+        double nsPerSampleMoving;   // coefficients recalculated every sample
+        std::vector<double> magnitudeError; // |H| - 1 per frequency [dB]
+        std::vector<double> phaseError;     // arg (H) - ideal per frequency [rad]
+        std::vector<double> tuningError;    // [cents]
+    };
+
+    JunctionInterpolatorBenchmark (double fs);
+
+    std::vector<Result> runAll();
+    static int runFromCommandLine (const String& commandLine);
+
+    std::vector<double> frequencies { 100.0, 500.0, 1000.0, 2000.0, 5000.0 };
+    int numAlfs = 64;
+    int numBenchmarkSamples = 1 << 22;
+
+private:
+    template <class Interpolator>
+    Result run();
+
+    double fs, h, L;
+    double checksum = 0;    // of the timed loops
+};
@@ -10,24 +10,26 @@
 
 #include <JuceHeader.h>
 #include "LipModel.h"
+#include "Denormals.h"
 
 //==============================================================================
-LipModel::LipModel (NamedValueSet& parameters, double k) : k (k),
-                                            lipFreqVal (*parameters.getVarPointer ("f0")),
-                                            omega0 (*parameters.getVarPointer ("omega0")),
-                                            M (*parameters.getVarPointer ("Mr")),
-                                            sig (*parameters.getVarPointer ("sigmaR")),
-                                            Kcol (*parameters.getVarPointer ("Kcol")),
-                                            alpha (*parameters.getVarPointer ("alphaCol")),
-                                            H0 (*parameters.getVarPointer ("H0")),
-                                            b (*parameters.getVarPointer ("barrier")),
-                                            Pm (*parameters.getVarPointer ("Pm"))
-
-{
-    if (Global::connectedToLip)
+LipModel::LipModel (const TromboneParameters& parameters, double k) : k (k),
+                                            lipFreqVal (parameters.f0),
+                                            omega0 (2.0 * double_Pi * parameters.f0),
+                                            M (parameters.Mr),
+                                            sig (parameters.sigmaR),
+                                            Kcol (parameters.Kcol),
+                                            alpha (parameters.alphaCol),
+                                            H0 (parameters.H0),
+                                            b (parameters.barrier),
+                                            Pm (parameters.Pm),
+                                            connectedToLip (parameters.connectedToLip)
+
+{
+    if (connectedToLip)
     {
-        Sr  = *parameters.getVarPointer ("Sr");
-        w = *parameters.getVarPointer ("w");
+        Sr  = parameters.Sr;
+        w = parameters.w;
         yPrev = H0;
     } else {
         w = 0;
@@ -36,8 +38,6 @@ LipModel::LipModel (NamedValueSet& parameters, double k) : k (k),
     }
     
     pressureVal = Pm;
-    // In your constructor, you should add any child components, and
-    // initialise any special settings that your component needs.
     oOk = 1.0 / k;
     oOM = 1.0 / M;
     
@@ -57,26 +57,6 @@ LipModel::~LipModel()
 {
 }
 
-void LipModel::paint (juce::Graphics& g)
-{
-    /* This demo code just fills the component's background and
-       draws some placeholder text to get you started.
-
-       You should replace everything in this method with your own
-       drawing code..
-    */
-
-    g.fillAll (Colours::yellow);   // clear the background;
-    g.drawText("Pressure: " + String(pressureVal) + "(Pa) LipFrequency: " + String (lipFreqVal) + "(Hz)", getWidth() - 300, getHeight() - 50, 300, 50, Justification::centredRight);
-    
-}
-
-void LipModel::resized()
-{
-    // This method is where you should set the bounds of any child
-    // components that your component contains..
-
-}
 void LipModel::setTubeParameters (double hIn, double rho, double c, double SBar0In, double SHalf0In)
 {
     h = hIn;
@@ -185,21 +165,44 @@ void LipModel::refreshInputParams()
 }
 
 
-void LipModel::mouseDown (const MouseEvent& e)
+void LipModel::resetStates()
 {
-    pressureVal = e.y * Global::pressureMultiplier;
-    lipFreqVal = e.x;
-    
+    // same as at construction
+    yPrev = connectedToLip ? H0 : 0;
+    y = 0;
+    yNext = 0;
+    psi = 0;
+    psiPrev = 0;
+    Ub = 0;
+    Ur = 0;
+    pHPrev = 0;
+    qHPrev = 0;
 }
 
-void LipModel::mouseDrag (const MouseEvent& e)
+int LipModel::countSubnormals()
 {
-    pressureVal = e.y * Global::pressureMultiplier;
-    lipFreqVal = e.x;
+    double states[] = { y, yPrev, yNext, psi, psiPrev, g, deltaP, Ub, Ur };
+    return Denormals::countSubnormals (states, static_cast<int> (std::size (states)));
 }
 
-void LipModel::mouseUp (const MouseEvent& e)
+double* LipModel::writeState (double* dest)
 {
-    pressureVal = 0;
+    for (double val : { y, yPrev, yNext, psi, psiPrev, g, deltaP, Ub, Ur, pHPrev, qHPrev,
+                        lipEnergy1, colEnergy1, Pm, omega0, pressureVal, lipFreqVal })
+        *dest++ = val;
+    return dest;
 }
 
+const double* LipModel::readState (const double* src, const double* end)
+{
+    if (end - src < getStateSize())
+        return nullptr;
+    
+    for (double* val : { &y, &yPrev, &yNext, &psi, &psiPrev, &g, &deltaP, &Ub, &Ur, &pHPrev, &qHPrev,
+                         &lipEnergy1, &colEnergy1, &Pm, &omega0, &pressureVal, &lipFreqVal })
+        *val = *src++;
+    
+    omega0Sq = omega0 * omega0;
+    a1Coeff = 2.0 * oOk + omega0Sq * k + sig;
+    return src;
+}
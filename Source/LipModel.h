@@ -12,18 +12,16 @@
 
 #include <JuceHeader.h>
 #include "Global.h"
+#include "TromboneParameters.h"
 
 //==============================================================================
 /*
 */
-class LipModel  : public juce::Component
+class LipModel
 {
 public:
-    LipModel (NamedValueSet& parameters, double k);
-    ~LipModel() override;
-
-    void paint (juce::Graphics&) override;
-    void resized() override;
+    LipModel (const TromboneParameters& parameters, double k);
+    ~LipModel();
 
     void setTubeParameters (double hIn, double rho, double c, double SBar0In, double SHalf0In);
     void setTubeStates (double p, double vNext) { p0 = p; vNext0 = vNext; };
@@ -48,12 +46,24 @@ public:
     double getPower();
     
     void refreshInputParams();
-
-    void mouseDown (const MouseEvent& e) override;
-    void mouseDrag (const MouseEvent& e) override;
-    void mouseUp (const MouseEvent& e) override;
+    
+    bool isStable (double threshold) { return std::abs (yNext) <= threshold && std::isfinite (psi); };
+    void resetStates();
+    int countSubnormals();
+    
+    // state snapshots (see TromboneState)
+    int getStateSize() { return 17; };
+    double* writeState (double* dest);
+    const double* readState (const double* src, const double* end);
+    
+    // set the input values that are applied at the next refreshInputParams() call
+    void setPressureVal (double p) { pressureVal = p; };
+    void setLipFreqVal (double f) { lipFreqVal = f; };
+    double getPressureVal() { return pressureVal; };
+    double getLipFreqVal() { return lipFreqVal; };
     
 private:
+    
     double k, omega0, M, sig, Sr, w, Kcol, alpha, H0, b, eta, g, psi, psiPrev, Pm, Ub, Ur;
     double oOk, omega0Sq, kO2M, oOM, oOa1, oO2k;
     double h, SBar0, SHalf0, vNext0, p0;
@@ -76,6 +86,7 @@ private:
     
     double pressureVal;
     double lipFreqVal;
+    bool connectedToLip;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LipModel)
 };
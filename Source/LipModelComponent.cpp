@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    LipModelComponent.cpp
+    Created: 19 Oct 2026 8:14:41pm
+    Author:  Silvin Willemsen
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "LipModelComponent.h"
+
+//==============================================================================
+LipModelComponent::LipModelComponent (LipModel& lipModel) : lipModel (lipModel)
+{
+}
+
+LipModelComponent::~LipModelComponent()
+{
+}
+
+void LipModelComponent::paint (juce::Graphics& g)
+{
+    /* This demo code just fills the component's background and
+       draws some placeholder text to get you started.
+
+       You should replace everything in this method with your own
+       drawing code..
+    */
+
+    g.fillAll (Colours::yellow);   // clear the background;
+    g.drawText("Pressure: " + String (lipModel.getPressureVal()) + "(Pa) LipFrequency: " + String (lipModel.getLipFreqVal()) + "(Hz)", getWidth() - 300, getHeight() - 50, 300, 50, Justification::centredRight);
+    
+}
+
+void LipModelComponent::resized()
+{
+    // This method is where you should set the bounds of any child
+    // components that your component contains..
+
+}
+
+void LipModelComponent::mouseDown (const MouseEvent& e)
+{
+    lipModel.setPressureVal (e.y * Global::pressureMultiplier);
+    lipModel.setLipFreqVal (e.x);
+}
+
+void LipModelComponent::mouseDrag (const MouseEvent& e)
+{
+    lipModel.setPressureVal (e.y * Global::pressureMultiplier);
+    lipModel.setLipFreqVal (e.x);
+}
+
+void LipModelComponent::mouseUp (const MouseEvent& e)
+{
+    lipModel.setPressureVal (0);
+}
@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    LipModelComponent.h
+    Created: 19 Oct 2026 8:14:41pm
+    Author:  Silvin Willemsen
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "LipModel.h"
+
+//==============================================================================
+/*
+    Shows the input of a LipModel and sets it with the mouse (y: pressure, x: lip frequency).
+*/
+class LipModelComponent  : public juce::Component
+{
+public:
+    LipModelComponent (LipModel& lipModel);
+    ~LipModelComponent() override;
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+    void mouseDown (const MouseEvent& e) override;
+    void mouseDrag (const MouseEvent& e) override;
+    void mouseUp (const MouseEvent& e) override;
+
+private:
+    LipModel& lipModel;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LipModelComponent)
+};
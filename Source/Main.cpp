@@ -10,6 +10,21 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "MainComponent.h"
+#include "ScoreRenderer.h"
+#include "JunctionInterpolator.h"
+#include "HeadlessAudioDevice.h"
+#include "InputImpedance.h"
+#include "ConvolutionTrombone.h"
+#include "HybridTrombone.h"
+#include "ImplicitTrombone.h"
+#include "TromboneEngine.h"
+#include "Denormals.h"
+#include "EngineAutotuner.h"
+#include "Telemetry.h"
+#include "ControlStream.h"
+#include "ParameterEstimator.h"
+#include "TromboneSection.h"
+#include "NonlinearBenchmark.h"
 
 //==============================================================================
 class TromboneApplication  : public JUCEApplication
@@ -26,8 +41,134 @@ public:
     void initialise (const String& commandLine) override
     {
         // This method is where you should put your application's initialisation code..
+        Diagnostics::start();
 
-        mainWindow.reset (new MainWindow (getApplicationName()));
+        // headless offline rendering of a midi file
+        if (commandLine.contains ("--render"))
+        {
+            setApplicationReturnValue (ScoreRenderer::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        // fit the parameters to a recorded tone
+        if (commandLine.contains ("--fit"))
+        {
+            setApplicationReturnValue (ParameterEstimator::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        if (commandLine.contains ("--benchmark-junction"))
+        {
+            setApplicationReturnValue (JunctionInterpolatorBenchmark::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        // resonances of the bore at all slide positions (frequency domain)
+        if (commandLine.contains ("--impedance"))
+        {
+            setApplicationReturnValue (InputImpedance::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        // cost of the convolution fast mode vs the full FDTD model
+        if (commandLine.contains ("--benchmark-convolution"))
+        {
+            setApplicationReturnValue (ConvolutionTrombone::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        // cost and tuning of the hybrid waveguide/FDTD mode vs the full FDTD model
+        if (commandLine.contains ("--benchmark-hybrid"))
+        {
+            setApplicationReturnValue (HybridTrombone::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        // the explicit scheme vs the implicit one on the same grid at a lower rate
+        if (commandLine.contains ("--benchmark-implicit"))
+        {
+            setApplicationReturnValue (ImplicitTrombone::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        // compile-time sized grids vs the runtime sized engine
+        if (commandLine.contains ("--benchmark-fixed"))
+        {
+            setApplicationReturnValue (TromboneEngine::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        // drive an engine with a recorded performance
+        if (commandLine.contains ("--replay"))
+        {
+            setApplicationReturnValue (ControlStream::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        // tail the metrics of a running instance
+        if (commandLine.contains ("--telemetry"))
+        {
+            setApplicationReturnValue (TelemetryReader::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        // pick (and cache) the fastest engine variant for this machine
+        if (commandLine.contains ("--autotune"))
+        {
+            setApplicationReturnValue (EngineAutotuner::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        // decay tails with and without flush-to-zero
+        if (commandLine.contains ("--benchmark-denormals"))
+        {
+            setApplicationReturnValue (DenormalBenchmark::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        // voices in lockstep SIMD lanes vs as many trombones
+        if (commandLine.contains ("--benchmark-section"))
+        {
+            setApplicationReturnValue (TromboneSectionBenchmark::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        // harmonics of the convective term against the level
+        if (commandLine.contains ("--benchmark-nonlinear"))
+        {
+            setApplicationReturnValue (NonlinearBenchmark::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+        
+        // real-time behaviour without sound hardware
+        if (commandLine.contains ("--benchmark-callback"))
+        {
+            setApplicationReturnValue (CallbackBenchmark::runFromCommandLine (commandLine));
+            quit();
+            return;
+        }
+
+        // record the controls of this session: --record-controls=controls.trcs
+        ArgumentList args ("Trombone", commandLine);
+        File controlRecordingFile;
+        if (args.containsOption ("--record-controls"))
+            controlRecordingFile = File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--record-controls").unquoted());
+
+        mainWindow.reset (new MainWindow (getApplicationName(), controlRecordingFile));
     }
 
     void shutdown() override
@@ -35,6 +176,7 @@ public:
         // Add your application's shutdown code here..
 
         mainWindow = nullptr; // (deletes our window)
+        Diagnostics::stop();
     }
 
     //==============================================================================
@@ -60,13 +202,13 @@ public:
     class MainWindow    : public DocumentWindow
     {
     public:
-        MainWindow (String name)  : DocumentWindow (name,
+        MainWindow (String name, const File& controlRecordingFile)  : DocumentWindow (name,
                                                     Desktop::getInstance().getDefaultLookAndFeel()
                                                                           .findColour (ResizableWindow::backgroundColourId),
                                                     DocumentWindow::allButtons)
         {
             setUsingNativeTitleBar (true);
-            setContentOwned (new MainComponent(), true);
+            setContentOwned (new MainComponent (controlRecordingFile), true);
             setResizable (true, true);
 
             centreWithSize (getWidth(), getHeight());
@@ -7,75 +7,79 @@
 */
 
 #include "MainComponent.h"
+#include "Denormals.h"
 
 //==============================================================================
-MainComponent::MainComponent()
+MainComponent::MainComponent (const File& controlRecordingFile) : controlRecordingFile (controlRecordingFile),
+                                                                     recordControls (controlRecordingFile != File())
 {
     // Make sure you set the size of the component after
     // you add any child components.
     
     // specify the number of input and output channels that we want to open
     setAudioChannels (0, 2);
-    startTimerHz (15);
+    
+    updateMidiInputs();
+    startTimerHz (curVisualisationRate);
 }
 
 MainComponent::~MainComponent()
 {
     // This shuts down the audio device and clears the audio source.
     stopTimer();
+    for (auto& identifier : midiInputIdentifiers)
+        deviceManager.removeMidiInputDeviceCallback (identifier, &midiCollector);
     shutdownAudio();
 }
 
+void MainComponent::updateMidiInputs()
+{
+    // JUCE 6 doesn't notify about new MIDI devices, so the list is polled (see timerCallback)
+    lastMidiInputCheck = Time::getMillisecondCounterHiRes();
+    for (auto& input : MidiInput::getAvailableDevices())
+    {
+        if (midiInputIdentifiers.contains (input.identifier))
+            continue;
+        
+        deviceManager.setMidiInputDeviceEnabled (input.identifier, true);
+        deviceManager.addMidiInputDeviceCallback (input.identifier, &midiCollector);
+        midiInputIdentifiers.add (input.identifier);
+    }
+}
+
 //==============================================================================
 void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
 {
     fs = sampleRate;
-    NamedValueSet parameters;
-    
-    //// Tube ////
-    parameters.set ("T", 26.85);
-    parameters.set ("L", 2.658);
-    parameters.set ("LnonExtended", 2.658);
-
-    // Geometry
-//    parameters.set ("mp", 0.015 * 0.015 * double_Pi);                   // mouthpiece cross-sectional area
-//    parameters.set ("mpL", 0.01);                   // mouthpiece length (length ratio)
-//    parameters.set ("m2tL", 0.01);                  // mouthpiece to tube (length ratio)
-//    parameters.set ("tubeS", 0.01 * 0.01 * double_Pi);                 // tube cross-sectional area
-    
-    // Geometric information including formula from bell taken from T. Smyth "Trombone synthesis by model and measurement"
-    geometry = {
-        {0.708, 0.177, 0.711, 0.306, 0.254, 0.502},         // lengths (changed fourth entry to account for bell length "error" in paper)
-        {0.0069, 0.0072, 0.0069, 0.0071, 0.0075, 0.0107}    // radii
-    };
-    
-    parameters.set ("flare", 0.7);                 // flare (exponent coeff)
-    parameters.set ("x0", 0.0174);                    // position of bell mouth (exponent coeff)
-    parameters.set ("b", 0.0063);                   // fitting parameter
-    parameters.set ("bellL", 0.21);                  // bell (length ratio)
+    governor.prepare (samplesPerBlockExpected, sampleRate);
+    midiCollector.reset (sampleRate);
+    incomingMidi.ensureSize (4096);
     
-    //// Lip ////
-    double f0 = 300.0;
-    double H0 = 2.9e-4;
-    parameters.set("f0", f0);                       // fundamental freq lips
-    parameters.set("Mr", 5.37e-5);                  // mass lips
-    parameters.set("omega0", 2.0 * double_Pi * f0); // angular freq
+    // use the preset in the working directory if there is one
+    TromboneParameters parameters;
+    String error;
+    File preset = File::getCurrentWorkingDirectory().getChildFile ("trombone.preset");
+    if (preset.existsAsFile() && !parameters.loadFromFile (preset, error))
+        std::cout << "Could not load preset: " << error << std::endl;
     
-    parameters.set("sigmaR", 5);                    // damping
-    parameters.set("H0", H0);                   // equilibrium
-    parameters.set("barrier", -H0);                   // equilibrium
-
-    parameters.set("w", 1e-2);                      // lip width
-    parameters.set("Sr", 1.46e-5);                  // lip area
-    
-    parameters.set ("Kcol", 10000);
-    parameters.set ("alphaCol", 3);
-    
-    //// Input ////
-    parameters.set ("Pm", 300 * Global::pressureMultiplier);
+    if (!parameters.validate (1.0 / fs, error))
+    {
+        std::cout << "Invalid preset (" << error << "), using the default parameters" << std::endl;
+        parameters = TromboneParameters();
+    }
     
-    trombone = std::make_unique<Trombone> (parameters, 1.0 / fs, geometry);
-    addAndMakeVisible (trombone.get());
+    // the component refers to the trombone, so it needs to go first
+    tromboneComponent = nullptr;
+    trombone = std::make_unique<Trombone> (parameters, 1.0 / fs);
+    tromboneComponent = std::make_unique<TromboneComponent> (*trombone);
+    sampleIndex = 0;
+    if (recordControls)
+    {
+        controlStream.prepareToRecord (fs, parameters, maxNumControlEvents);
+        controlStream.setInitialValue (ControlStream::slideLength, trombone->getTube().getTargetL());
+        controlStream.setInitialValue (ControlStream::temperature, trombone->getTube().getTargetT());
+    }
+    addAndMakeVisible (tromboneComponent.get());
     
     setSize (800, 600);
 
@@ -90,26 +94,171 @@ void MainComponent::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFil
     // Right now we are not producing any data, in which case we need to clear the buffer
     // (to prevent the output of random noise)
     
+    ScopedFlushToZero flushToZero;
+    governor.beginBlock();
+    trombone->setEnergyInterval (governor.getEnergyInterval());
+    saveToFiles = governor.shouldSaveToFiles();
+    
     float* const channelData1 = bufferToFill.buffer->getWritePointer (0, bufferToFill.startSample);
     float* const channelData2 = bufferToFill.buffer->getWritePointer (1, bufferToFill.startSample);
     
+    midiCollector.removeNextBlockOfMessages (incomingMidi, bufferToFill.numSamples);
+    
+    if (incomingMidi.isEmpty())
+    {
+        processSamples (0, bufferToFill.numSamples);
+    }
+    else
+    {
+        // split the block at the MIDI events so that they are applied at the exact sample
+        int curSample = 0;
+        for (const auto metadata : incomingMidi)
+        {
+            int eventSample = jlimit (curSample, bufferToFill.numSamples, metadata.samplePosition);
+            processSamples (curSample, eventSample);
+            handleMidiMessage (metadata.getMessage());
+            curSample = eventSample;
+        }
+        processSamples (curSample, bufferToFill.numSamples);
+    }
+    
+    if (t > 1000)
+    {
+        trombone->closeFiles();
+        DIAGNOSTIC_INFO ("done", t);
+    }
+    refreshInputParams();
+    governor.endBlock (bufferToFill.numSamples);
+    publishTelemetry (bufferToFill.numSamples);
+}
+
+void MainComponent::publishTelemetry (int numSamples)
+{
+    auto& data = telemetryData;
+    ++data.blockIndex;
+    data.samplesProcessed += numSamples;
+    data.sampleRate = fs;
+    data.callbackTime = governor.getLastCallbackTime() * 1000.0;
+    data.load = governor.getLastLoad();
+    data.energy = trombone->getScaledTotEnergy();
+    data.peak = blockPeak;
+    data.rms = numSamples > 0 ? sqrt (blockSumSquares / numSamples) : 0;
+    data.y = trombone->getLipModel().getY();
+    data.Pm = trombone->getLipModel().getPressureVal() * Global::oOPressureMultiplier;
+    data.f0 = trombone->getLipModel().getLipFreqVal();
+    data.recoveries = trombone->getNumRecoveries();
+    data.disabled = trombone->isDisabled() ? 1 : 0;
+    data.xruns = governor.getXruns();
+    data.nearMisses = governor.getNearMisses();
+    telemetry.publish (data);
+
+    blockPeak = 0;
+    blockSumSquares = 0;
+}
+
+void MainComponent::processSamples (int start, int end)
+{
     float output = 0.0;
-    float output2 = 0.0;
     
-    for (int i = 0; i < bufferToFill.numSamples; ++i)
+    for (int i = start; i < end; ++i)
     {
         trombone->calculate();
         output = trombone->getOutput() * 0.001 * Global::oOPressureMultiplier;
-        trombone->saveToFiles();
+        blockPeak = jmax (blockPeak, std::abs (output));
+        blockSumSquares += output * output;
+        if (saveToFiles)
+            trombone->saveToFiles();
         trombone->updateStates();
 //        channelData1[i] = Global::outputClamp (output);
 //        channelData2[i] = Global::outputClamp (output);
         ++t;
+        ++sampleIndex;
     }
-    if (t > 1000)
+}
+
+void MainComponent::handleMidiMessage (const MidiMessage& message)
+{
+    // Monophonic (last note priority). Notes set the pressure (velocity), lip frequency and slide,
+    // the breath controller (CC 2) and expression (CC 11) set the pressure, the mod wheel (CC 1)
+    // moves the slide from first to seventh position and the pitch wheel bends the lips by 2 semitones.
+    if (message.isNoteOn())
     {
-        trombone->closeFiles();
-        std::cout << "done" << std::endl;
+        curNote = message.getNoteNumber();
+        noteFreq = MidiMessage::getMidiNoteInHertz (curNote);
+        trombone->setInputParams (message.getFloatVelocity() * maxPressure, noteFreq * pitchBend);
+        trombone->setTargetL (trombone->getSlideLength (noteFreq));
+        trombone->resetWatchdog();
+    }
+    else if (message.isNoteOff() && message.getNoteNumber() == curNote)
+    {
+        curNote = -1;
+        trombone->setInputParams (0, noteFreq * pitchBend);
+    }
+    else if (message.isAllNotesOff())
+    {
+        curNote = -1;
+        trombone->setInputParams (0, noteFreq * pitchBend);
+    }
+    else if (message.isController())
+    {
+        double value = message.getControllerValue() / 127.0;
+        switch (message.getControllerNumber())
+        {
+            case 1:
+                trombone->setTargetL (trombone->getLnonExtended() * pow (2.0, 6.0 * value / 12.0));
+                break;
+            case 2:
+            case 11:
+                trombone->setPressure (value * maxPressure);
+                break;
+            default:
+                return;
+        }
+    }
+    else if (message.isPitchWheel())
+    {
+        pitchBend = pow (2.0, 2.0 * (message.getPitchWheelValue() - 8192) / (8192.0 * 12.0));
+        if (noteFreq > 0)
+            trombone->setLipFrequency (noteFreq * pitchBend);
+    }
+    else
+    {
+        return;
+    }
+    refreshInputParams();
+}
+
+void MainComponent::refreshInputParams()
+{
+    // a voice muted by the watchdog is re-armed by a new note (see handleMidiMessage) or when its inputs change
+    auto& lip = trombone->getLipModel();
+    if (!trombone->isDisabled())
+    {
+        disabledPressure = -1;
+    }
+    else if (disabledPressure < 0)
+    {
+        disabledPressure = lip.getPressureVal();
+        disabledLipFreq = lip.getLipFreqVal();
+    }
+    else if (lip.getPressureVal() != disabledPressure || lip.getLipFreqVal() != disabledLipFreq)
+    {
+        trombone->resetWatchdog();
+        disabledPressure = -1;
+    }
+    
+    if (recordControls)
+    {
+        // the mouse sets the lip inputs from the message thread, read them once so that what is recorded is what is applied
+        auto& lipModel = trombone->getLipModel();
+        double pressure = lipModel.getPressureVal();
+        double lipFreq = lipModel.getLipFreqVal();
+        trombone->setInputParams (pressure, lipFreq);
+
+        controlStream.recordIfChanged (sampleIndex, ControlStream::pressure, pressure);
+        controlStream.recordIfChanged (sampleIndex, ControlStream::lipFrequency, lipFreq);
+        controlStream.recordIfChanged (sampleIndex, ControlStream::slideLength, trombone->getTube().getTargetL());
+        controlStream.recordIfChanged (sampleIndex, ControlStream::temperature, trombone->getTube().getTargetT());
     }
     trombone->refreshLipModelInputParams();
 }
@@ -120,6 +269,15 @@ void MainComponent::releaseResources()
     // restarted due to a setting change.
 
     // For more details, see the help for AudioProcessor::releaseResources()
+    
+    if (recordControls && trombone != nullptr)
+    {
+        controlStream.setNumSamples (sampleIndex);
+        if (!controlStream.writeToFile (controlRecordingFile))
+            std::cout << "Could not write " << controlRecordingFile.getFullPathName() << std::endl;
+        else if (controlStream.getNumDropped() > 0)
+            std::cout << controlStream.getNumDropped() << " control changes didn't fit in the recording" << std::endl;
+    }
 }
 
 //==============================================================================
@@ -131,15 +289,35 @@ void MainComponent::paint (Graphics& g)
     // You can add your drawing code here!
 }
 
+void MainComponent::paintOverChildren (Graphics& g)
+{
+    g.setColour (Colours::white);
+    g.drawText ("Load: " + String (governor.getLoad() * 100.0, 1) + "% Level: " + String (governor.getLevel())
+                + " Xruns: " + String (governor.getXruns()) + " Near misses: " + String (governor.getNearMisses())
+                + (trombone != nullptr ? " Recoveries: " + String (trombone->getNumRecoveries()) : String()),
+                0, 0, getWidth(), 20, Justification::centredRight);
+}
+
 void MainComponent::resized()
 {
     // This is called when the MainContentComponent is resized.
     // If you add any child components, this is where you should
     // update their positions.
-    trombone->setBounds (getLocalBounds());
+    if (tromboneComponent != nullptr)
+        tromboneComponent->setBounds (getLocalBounds());
 }
 
 void MainComponent::timerCallback()
 {
+    int visualisationRate = governor.getVisualisationRate();
+    if (visualisationRate != curVisualisationRate)
+    {
+        curVisualisationRate = visualisationRate;
+        startTimerHz (curVisualisationRate);
+    }
+    
+    if (Time::getMillisecondCounterHiRes() - lastMidiInputCheck >= midiInputCheckInterval)
+        updateMidiInputs();
+    
     repaint();
 }
@@ -11,6 +11,10 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "Global.h"
 #include "Trombone.h"
+#include "TromboneComponent.h"
+#include "CPUGovernor.h"
+#include "Telemetry.h"
+#include "ControlStream.h"
 
 //==============================================================================
 /*
@@ -21,7 +25,8 @@ class MainComponent   : public AudioAppComponent, public Timer
 {
 public:
     //==============================================================================
-    MainComponent();
+    // records all control changes to controlRecordingFile (if not empty), see ControlStream
+    MainComponent (const File& controlRecordingFile = {});
     ~MainComponent();
 
     //==============================================================================
@@ -31,16 +36,56 @@ public:
 
     //==============================================================================
     void paint (Graphics& g) override;
+    void paintOverChildren (Graphics& g) override;
     void resized() override;
 
     void timerCallback() override;
+    
+    void handleMidiMessage (const MidiMessage& message);
+    void updateMidiInputs();
+    void processSamples (int start, int end);
+    void publishTelemetry (int numSamples);
+    void refreshInputParams();
 
 private:
 
     // Your private member variables go here...
     std::unique_ptr<Trombone> trombone;
+    std::unique_ptr<TromboneComponent> tromboneComponent;
     double fs;
     long t = 0;
-    std::vector<std::vector<double>> geometry;
+    int64 sampleIndex = 0;  // since the trombone was created
+    
+    // recorded from the audio thread, written to the file when the audio stops
+    File controlRecordingFile;
+    bool recordControls;
+    ControlStream controlStream;
+    int maxNumControlEvents = 1 << 20;
+    
+    CPUGovernor governor;
+    
+    // per-block metrics for external monitoring (Trombone --telemetry --pid=<pid>)
+    TelemetryPublisher telemetry;
+    TelemetryData telemetryData {};
+    float blockPeak = 0;
+    double blockSumSquares = 0;
+    
+    // MIDI input, applied at the exact sample offset within the block. Devices that are plugged in
+    // later are picked up every midiInputCheckInterval ms (they stay enabled when they are unplugged)
+    MidiMessageCollector midiCollector;
+    StringArray midiInputIdentifiers;
+    double lastMidiInputCheck = 0;
+    double midiInputCheckInterval = 1000.0;
+    MidiBuffer incomingMidi;
+    int curNote = -1;
+    double noteFreq = 0;
+    double pitchBend = 1.0;
+    double maxPressure = 300 * Global::pressureMultiplier;
+    
+    // lip inputs when the watchdog disabled the voice (-1 while it isn't)
+    double disabledPressure = -1;
+    double disabledLipFreq = 0;
+    int curVisualisationRate = 15;
+    bool saveToFiles = true;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainComponent)
 };
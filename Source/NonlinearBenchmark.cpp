@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    NonlinearBenchmark.cpp
+    Created: 24 Oct 2026 9:12:40am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "NonlinearBenchmark.h"
+#include "Trombone.h"
+#include "ParameterEstimator.h"
+
+//==============================================================================
+int NonlinearBenchmark::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+    double fs = args.containsOption ("--fs") ? args.getValueForOption ("--fs").getDoubleValue() : 44100.0;
+    if (!(fs > 0))
+    {
+        std::cout << "Invalid sample rate" << std::endl;
+        return 1;
+    }
+
+    double k = 1.0 / fs;
+    int settleLength = static_cast<int> (fs);
+    int analysisLength = static_cast<int> (0.5 * fs);
+    const int numHarmonics = 8;
+
+    TromboneParameters linearParameters;
+    linearParameters.connectedToLip = true;
+    TromboneParameters nonlinearParameters = linearParameters;
+    nonlinearParameters.nonlinearThreshold = 1.0; // always on
+
+    // renders a trombone, returns the time per sample [ns] (0 if it blew up) and writes the output after the settling time
+    auto play = [&] (const TromboneParameters& parameters, std::vector<float>& output, std::vector<double>* flow)
+    {
+        Trombone trombone (parameters, k);
+        trombone.setEnergyInterval (std::numeric_limits<int>::max());
+        output.clear();
+        double start = Time::getMillisecondCounterHiRes();
+        for (int n = 0; n < settleLength + analysisLength; ++n)
+        {
+            trombone.calculate();
+            if (n >= settleLength)
+            {
+                output.push_back (static_cast<float> (trombone.getOutput()));
+                if (flow != nullptr)
+                    flow->push_back (trombone.getLipModel().getUb() + trombone.getLipModel().getUr());
+            }
+            trombone.updateStates();
+        }
+        double time = (Time::getMillisecondCounterHiRes() - start) * 1e6 / (settleLength + analysisLength);
+        return trombone.getNumRecoveries() == 0 ? time : 0.0;
+    };
+
+    // drives a tube with a sinusoidal flow, false if it blew up
+    auto drive = [&] (bool nonlinear, double mean, double amplitude, double f, std::vector<float>& output)
+    {
+        Tube tube (nonlinearParameters, k);
+        tube.setNonlinear (nonlinear);
+        output.clear();
+        for (int n = 0; n < settleLength + analysisLength; ++n)
+        {
+            tube.calculateVelocity();
+            tube.setFlowVelocities (mean + amplitude * sin (2.0 * double_Pi * f * n * k), 0);
+            tube.calculatePressure();
+            tube.calculateRadiation();
+            if (n >= settleLength)
+                output.push_back (tube.getOutput());
+            tube.updateStates();
+        }
+        return std::all_of (output.begin(), output.end(), [] (float x) { return std::isfinite (x); });
+    };
+
+    auto centroid = [] (const ParameterEstimator::Features& features)
+    {
+        double sum = 0, weightedSum = 0;
+        for (int h = 0; h < static_cast<int> (features.levels.size()); ++h)
+        {
+            double power = pow (10.0, 0.1 * features.levels[h]);
+            sum += power;
+            weightedSum += (h + 1) * power;
+        }
+        return weightedSum / sum;
+    };
+
+    bool ok = true;
+    double prevCentroid = 0;
+    std::vector<float> output;
+    for (double Pm : { 300.0, 600.0, 1200.0, 2000.0 })
+    {
+        linearParameters.Pm = Pm * Global::pressureMultiplier;
+        nonlinearParameters.Pm = linearParameters.Pm;
+
+        // the lip flow of the linear note
+        std::vector<double> flow;
+        double linearTime = play (linearParameters, output, &flow);
+        ParameterEstimator::Features linearNote;
+        ParameterEstimator::analyse (output.data(), analysisLength, fs, numHarmonics, linearNote);
+        double nonlinearTime = play (nonlinearParameters, output, nullptr);
+        ParameterEstimator::Features nonlinearNote;
+        ParameterEstimator::analyse (output.data(), analysisLength, fs, numHarmonics, nonlinearNote);
+        if (!(linearTime > 0) || !(nonlinearTime > 0) || linearNote.pitch <= 0 || nonlinearNote.pitch <= 0)
+        {
+            std::cout << "Pm " << Pm << ": the note blew up or has no pitch" << std::endl;
+            ok = false;
+            continue;
+        }
+
+        // the mean and the (Hann windowed) fundamental of the flow, the lip motion adds narrow peaks on top of it
+        double mean = 0, sumRe = 0, sumIm = 0, sumWindow = 0;
+        for (int n = 0; n < analysisLength; ++n)
+        {
+            double window = 0.5 * (1.0 - cos (2.0 * double_Pi * n / analysisLength));
+            double phase = 2.0 * double_Pi * linearNote.pitch * n * k;
+            mean += flow[n] / analysisLength;
+            sumRe += window * flow[n] * cos (phase);
+            sumIm += window * flow[n] * sin (phase);
+            sumWindow += window;
+        }
+        double amplitude = 2.0 * sqrt (sumRe * sumRe + sumIm * sumIm) / sumWindow;
+
+        ParameterEstimator::Features linearTube, nonlinearTube;
+        bool stable = drive (false, mean, amplitude, linearNote.pitch, output);
+        ParameterEstimator::analyse (output.data(), analysisLength, fs, numHarmonics, linearTube);
+        stable = drive (true, mean, amplitude, linearNote.pitch, output) && stable;
+        ParameterEstimator::analyse (output.data(), analysisLength, fs, numHarmonics, nonlinearTube);
+
+        // at the highest levels the energy moves on from the second harmonic to the higher ones, so the check is on the centroid
+        bool rises = stable && centroid (nonlinearTube) > prevCentroid;
+        ok = ok && rises;
+        prevCentroid = centroid (nonlinearTube);
+
+        std::cout << "Pm " << String (Pm, 0) << ": lip flow " << String (mean * Global::oOPressureMultiplier * 1e6, 2) << " +- "
+                  << String (amplitude * Global::oOPressureMultiplier * 1e6, 2) << " cm^3/s at " << String (linearNote.pitch, 1) << " Hz" << std::endl;
+        // the levels are relative to their mean
+        std::cout << "  propagation: harmonic centroid " << String (centroid (linearTube), 2) << " -> " << String (centroid (nonlinearTube), 2)
+                  << ", h2 " << String (linearTube.levels[1] - linearTube.levels[0], 1) << " -> " << String (nonlinearTube.levels[1] - nonlinearTube.levels[0], 1)
+                  << " dB, h3 " << String (linearTube.levels[2] - linearTube.levels[0], 1) << " -> " << String (nonlinearTube.levels[2] - nonlinearTube.levels[0], 1)
+                  << " dB " << (rises ? "ok" : "FAILED") << std::endl;
+        std::cout << "  played note: harmonic centroid " << String (centroid (linearNote), 2) << " -> " << String (centroid (nonlinearNote), 2)
+                  << ", " << String (linearTime, 0) << " -> " << String (nonlinearTime, 0) << " ns per sample" << std::endl;
+    }
+    return ok ? 0 : 1;
+}
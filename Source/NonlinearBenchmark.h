@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    NonlinearBenchmark.h
+    Created: 24 Oct 2026 9:12:40am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Harmonics of the convective term of the tube (Tube::setNonlinear())
+    against the level, at the default note for Pm = 300 to 2000:
+    - propagation: a linear and a nonlinear Tube (both on the grid of a
+      nonlinear tube) driven by a sinusoidal flow with the pitch, mean and
+      fundamental of the lip flow of the note. The linear tube passes the sine
+      on, the harmonic centroid at the bell of the nonlinear one needs to
+      rise with Pm;
+    - the played note: the harmonics of a linear and a nonlinear Trombone and
+      their cost. Reported only: at the levels the lip model holds, the bore
+      smooths the steep closing of the lips (an expansion front) more than it
+      steepens their opening, so the note doesn't get brighter.
+
+    Fails (exit code 1) if the centroid of the nonlinear tube doesn't rise or
+    anything blows up.
+
+    Usage: Trombone --benchmark-nonlinear [--fs=44100]
+*/
+class NonlinearBenchmark
+{
+public:
+    static int runFromCommandLine (const String& commandLine);
+};
@@ -0,0 +1,589 @@
+/*
+  ==============================================================================
+
+    ParameterEstimator.cpp
+    Created: 21 Oct 2026 8:37:14pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ParameterEstimator.h"
+#include "Denormals.h"
+
+//==============================================================================
+ParameterEstimator::ParameterEstimator (const TromboneParameters& initialParameters, double fs, int numThreads) : initialParameters (initialParameters),
+                                                                                                                  fs (fs),
+                                                                                                                  k (1.0 / fs),
+                                                                                                                  numThreads (numThreads),
+                                                                                                                  bestParameters (initialParameters),
+                                                                                                                  pool (numThreads)
+{
+    // the renders are compared to a played note, so the lip always drives the tube
+    this->initialParameters.connectedToLip = true;
+    bestParameters.connectedToLip = true;
+}
+
+ParameterEstimator::~ParameterEstimator()
+{
+}
+
+bool ParameterEstimator::getValue (TromboneParameters parameters, const String& name, double& value)
+{
+    bool found = false;
+    parameters.forEachValue ([&] (const char* paramName, double& param) {
+        if (name == paramName)
+        {
+            value = param;
+            found = true;
+        }
+    });
+    return found;
+}
+
+bool ParameterEstimator::setFitParameters (const StringArray& names, String& error)
+{
+    fitNames.clear();
+    initialValues.clear();
+    for (auto& name : names)
+    {
+        double value = -1;
+        if (!getValue (initialParameters, name, value))
+        {
+            error = "Unknown parameter " + name;
+            return false;
+        }
+        if (!(value > 0))
+        {
+            error = name + " needs a positive initial value to be fitted";
+            return false;
+        }
+        fitNames.add (name);
+        initialValues.push_back (value);
+    }
+    return true;
+}
+
+bool ParameterEstimator::setTarget (const float* samples, int numSamples, String& error)
+{
+    analyse (samples, numSamples, fs, numHarmonics, targetFeatures);
+    if (targetFeatures.pitch <= 0)
+    {
+        error = "The target has no pitch";
+        return false;
+    }
+    analysisLength = std::min (numSamples, static_cast<int> (maxAnalysisTime * fs));
+    return true;
+}
+
+void ParameterEstimator::analyse (const float* samples, int numSamples, double fs, int numHarmonics, Features& features)
+{
+    features.pitch = 0;
+    features.levels.assign (numHarmonics, 0);
+
+    // YIN over two periods of the lowest pitch
+    const double fMin = 30.0, fMax = 1500.0;
+    const double threshold = 0.15;
+    int minLag = std::max (2, static_cast<int> (fs / fMax));
+    int maxLag = static_cast<int> (fs / fMin);
+    int window = 2 * maxLag;
+    if (numSamples < window + maxLag + 2)
+        return;
+
+    std::vector<double> cmnd (maxLag + 2, 1.0);
+    double sum = 0;
+    for (int tau = 1; tau <= maxLag + 1; ++tau)
+    {
+        double d = 0;
+        for (int j = 0; j < window; ++j)
+        {
+            double diff = samples[j] - samples[j + tau];
+            d += diff * diff;
+        }
+        sum += d;
+        cmnd[tau] = sum > 0 ? d * tau / sum : 1.0;
+    }
+
+    int best = -1;
+    for (int tau = minLag; tau <= maxLag; ++tau)
+    {
+        if (cmnd[tau] < threshold)
+        {
+            while (tau < maxLag && cmnd[tau + 1] < cmnd[tau])
+                ++tau;
+            best = tau;
+            break;
+        }
+    }
+    if (best < 0)
+    {
+        best = minLag;
+        for (int tau = minLag; tau <= maxLag; ++tau)
+            if (cmnd[tau] < cmnd[best])
+                best = tau;
+        if (cmnd[best] > 0.5)
+            return;
+    }
+
+    double den = cmnd[best - 1] - 2.0 * cmnd[best] + cmnd[best + 1];
+    double lag = best + (den > 0 ? 0.5 * (cmnd[best - 1] - cmnd[best + 1]) / den : 0.0);
+    features.pitch = fs / lag;
+
+    // levels of the harmonics, averaged over Hann windowed frames of about 0.1 s (half overlapping), so that the
+    // main lobes are wide enough for small pitch errors and slow modulations. The rotation is applied recursively.
+    int frameLength = std::min (numSamples, static_cast<int> (0.1 * fs));
+    int hop = frameLength / 2;
+    std::vector<double> hann (frameLength);
+    for (int n = 0; n < frameLength; ++n)
+        hann[n] = 0.5 * (1.0 - cos (2.0 * double_Pi * n / frameLength));
+
+    const double floorDb = -300.0;
+    double maxDb = floorDb;
+    for (int h = 0; h < numHarmonics; ++h)
+    {
+        double f = (h + 1) * features.pitch;
+        if (f >= 0.5 * fs)
+        {
+            features.levels[h] = floorDb;
+            continue;
+        }
+
+        double cs = cos (2.0 * double_Pi * f / fs);
+        double sn = sin (2.0 * double_Pi * f / fs);
+        double power = 0;
+        int numFrames = 0;
+        for (int start = 0; start + frameLength <= numSamples; start += hop)
+        {
+            double re = 1, im = 0, sumRe = 0, sumIm = 0;
+            for (int n = 0; n < frameLength; ++n)
+            {
+                double x = hann[n] * samples[start + n];
+                sumRe += x * re;
+                sumIm -= x * im;
+                double tmp = re * cs - im * sn;
+                im = re * sn + im * cs;
+                re = tmp;
+            }
+            power += sumRe * sumRe + sumIm * sumIm;
+            ++numFrames;
+        }
+        features.levels[h] = 10.0 * log10 (power / numFrames + 1e-300);
+        maxDb = std::max (maxDb, features.levels[h]);
+    }
+
+    // harmonics (far) below the strongest one are noise
+    double mean = 0;
+    for (auto& level : features.levels)
+    {
+        level = std::max (level, maxDb - 80.0);
+        mean += level;
+    }
+    mean /= numHarmonics;
+    for (auto& level : features.levels)
+        level -= mean;
+}
+
+double ParameterEstimator::calculateDistance (const Features& features)
+{
+    if (!(features.pitch > 0))
+        return invalidDistance;
+
+    double cents = 1200.0 * log2 (features.pitch / targetFeatures.pitch);
+
+    double sumSq = 0;
+    int num = std::min (features.levels.size(), targetFeatures.levels.size());
+    for (int h = 0; h < num; ++h)
+        sumSq += (features.levels[h] - targetFeatures.levels[h]) * (features.levels[h] - targetFeatures.levels[h]);
+    double rmsDb = num > 0 ? sqrt (sumSq / num) : 0.0;
+
+    return (cents / centsPerUnit) * (cents / centsPerUnit) + (rmsDb / dbPerUnit) * (rmsDb / dbPerUnit);
+}
+
+double ParameterEstimator::evaluate (const TromboneParameters& parameters, const TromboneState& state, TromboneState* finalState)
+{
+    String error;
+    if (analysisLength <= 0 || !parameters.validate (k, error))
+        return invalidDistance;
+
+    Trombone trombone (parameters, k);
+    trombone.setEnergyInterval (std::numeric_limits<int>::max());
+
+    // the snapshot has the pressure and lip frequency it was taken at
+    bool warm = !state.isEmpty() && trombone.setState (state, true);
+    if (warm)
+    {
+        trombone.setInputParams (parameters.Pm, parameters.f0);
+        trombone.refreshLipModelInputParams();
+    }
+
+    int numSettle = static_cast<int> ((warm ? warmSettleTime : coldSettleTime) * fs);
+    std::vector<float> output (analysisLength);
+
+    ScopedFlushToZero flushToZero;
+    for (int n = 0; n < numSettle + analysisLength; ++n)
+    {
+        trombone.calculate();
+        if (n >= numSettle)
+            output[n - numSettle] = trombone.getOutput();
+        trombone.updateStates();
+    }
+
+    for (float val : output)
+        if (!std::isfinite (val))
+            return invalidDistance;
+
+    if (finalState != nullptr)
+        trombone.getState (*finalState);
+
+    Features features;
+    analyse (output.data(), analysisLength, fs, numHarmonics, features);
+    return calculateDistance (features);
+}
+
+TromboneParameters ParameterEstimator::getParameters (const std::vector<double>& x)
+{
+    TromboneParameters parameters = initialParameters;
+    double logRange = log (range);
+    for (int i = 0; i < fitNames.size(); ++i)
+    {
+        double value = initialValues[i] * exp (Global::limit (x[i], -1.0, 1.0) * logRange);
+        parameters.forEachValue ([&] (const char* paramName, double& param) {
+            if (fitNames[i] == paramName)
+                param = value;
+        });
+    }
+    return parameters;
+}
+
+double ParameterEstimator::run (int maxGenerations, double maxSeconds)
+{
+    double startTime = Time::getMillisecondCounterHiRes();
+    int n = fitNames.size();
+
+    // the initial parameters, from rest. This is also the first snapshot to warm start from.
+    TromboneState initialState;
+    bestParameters = initialParameters;
+    bestDistance = evaluate (initialParameters, TromboneState(), &initialState);
+    bestState = initialState;
+    numEvaluations = 1;
+    if (n == 0)
+        return bestDistance;
+
+    // CMA-ES (the standard settings, see N. Hansen, "The CMA Evolution Strategy: A Tutorial")
+    int lambda = populationSize > 0 ? populationSize : std::max (4 + static_cast<int> (3.0 * log (n)), numThreads);
+    int mu = lambda / 2;
+    std::vector<double> weights (mu);
+    double sumWeights = 0;
+    for (int i = 0; i < mu; ++i)
+    {
+        weights[i] = log (mu + 0.5) - log (i + 1.0);
+        sumWeights += weights[i];
+    }
+    double sumSqWeights = 0;
+    for (auto& weight : weights)
+    {
+        weight /= sumWeights;
+        sumSqWeights += weight * weight;
+    }
+    double muEff = 1.0 / sumSqWeights;
+
+    double cc = (4.0 + muEff / n) / (n + 4.0 + 2.0 * muEff / n);
+    double cs = (muEff + 2.0) / (n + muEff + 5.0);
+    double c1 = 2.0 / ((n + 1.3) * (n + 1.3) + muEff);
+    double cmu = std::min (1.0 - c1, 2.0 * (muEff - 2.0 + 1.0 / muEff) / ((n + 2.0) * (n + 2.0) + muEff));
+    double damps = 1.0 + 2.0 * std::max (0.0, sqrt ((muEff - 1.0) / (n + 1.0)) - 1.0) + cs;
+    double chiN = sqrt (n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+
+    std::vector<double> mean (n, 0), pc (n, 0), ps (n, 0), D (n, 1.0), eigenValues (n);
+    std::vector<double> C (n * n, 0), B (n * n, 0), matrix (n * n);
+    for (int i = 0; i < n; ++i)
+    {
+        C[i * n + i] = 1.0;
+        B[i * n + i] = 1.0;
+    }
+    double sigma = initialStepSize;
+
+    Random random (seed);
+    auto gaussian = [&random] () {
+        double u1 = 1.0 - random.nextDouble();
+        double u2 = random.nextDouble();
+        return sqrt (-2.0 * log (u1)) * cos (2.0 * double_Pi * u2);
+    };
+
+    std::vector<std::vector<double>> ys (lambda, std::vector<double> (n)), xs (lambda, std::vector<double> (n));
+    std::vector<double> z (n), yw (n), tmp (n);
+    std::vector<int> order (lambda);
+
+    for (int generation = 0; generation < maxGenerations; ++generation)
+    {
+        // y = B * D * z, x = mean + sigma * y
+        for (int i = 0; i < lambda; ++i)
+        {
+            for (int j = 0; j < n; ++j)
+                z[j] = D[j] * gaussian();
+            for (int r = 0; r < n; ++r)
+            {
+                double val = 0;
+                for (int j = 0; j < n; ++j)
+                    val += B[r * n + j] * z[j];
+                ys[i][r] = val;
+                xs[i][r] = mean[r] + sigma * val;
+            }
+        }
+
+        std::vector<std::unique_ptr<Job>> jobs;
+        for (int i = 0; i < lambda; ++i)
+            jobs.push_back (std::make_unique<Job> (*this, getParameters (xs[i]), warmStart ? bestState : TromboneState()));
+        for (auto& job : jobs)
+            pool.addJob (job.get(), false);
+        for (auto& job : jobs)
+            pool.waitForJobToFinish (job.get(), -1);
+        numEvaluations += lambda;
+
+        for (int i = 0; i < lambda; ++i)
+            order[i] = i;
+        std::sort (order.begin(), order.end(), [&jobs] (int a, int b) { return jobs[a]->distance < jobs[b]->distance; });
+
+        if (jobs[order[0]]->distance < bestDistance)
+        {
+            bestDistance = jobs[order[0]]->distance;
+            bestParameters = getParameters (xs[order[0]]);
+            bestState = jobs[order[0]]->finalState;
+        }
+
+        // mean
+        std::fill (yw.begin(), yw.end(), 0.0);
+        for (int i = 0; i < mu; ++i)
+            for (int j = 0; j < n; ++j)
+                yw[j] += weights[i] * ys[order[i]][j];
+        for (int j = 0; j < n; ++j)
+            mean[j] = Global::limit (mean[j] + sigma * yw[j], -1.0, 1.0);
+
+        // evolution paths, C^{-1/2} * yw = B * D^{-1} * B^T * yw
+        for (int j = 0; j < n; ++j)
+        {
+            double val = 0;
+            for (int r = 0; r < n; ++r)
+                val += B[r * n + j] * yw[r];
+            tmp[j] = val / D[j];
+        }
+        double psNorm = 0;
+        for (int r = 0; r < n; ++r)
+        {
+            double val = 0;
+            for (int j = 0; j < n; ++j)
+                val += B[r * n + j] * tmp[j];
+            ps[r] = (1.0 - cs) * ps[r] + sqrt (cs * (2.0 - cs) * muEff) * val;
+            psNorm += ps[r] * ps[r];
+        }
+        psNorm = sqrt (psNorm);
+
+        bool hSig = psNorm / sqrt (1.0 - pow (1.0 - cs, 2.0 * (generation + 1))) / chiN < 1.4 + 2.0 / (n + 1.0);
+        for (int j = 0; j < n; ++j)
+            pc[j] = (1.0 - cc) * pc[j] + (hSig ? sqrt (cc * (2.0 - cc) * muEff) * yw[j] : 0.0);
+
+        // covariance: rank-one and rank-mu update
+        for (int r = 0; r < n; ++r)
+        {
+            for (int j = 0; j <= r; ++j)
+            {
+                double rankMu = 0;
+                for (int i = 0; i < mu; ++i)
+                    rankMu += weights[i] * ys[order[i]][r] * ys[order[i]][j];
+                double val = (1.0 - c1 - cmu) * C[r * n + j]
+                             + c1 * (pc[r] * pc[j] + (hSig ? 0.0 : cc * (2.0 - cc) * C[r * n + j]))
+                             + cmu * rankMu;
+                C[r * n + j] = val;
+                C[j * n + r] = val;
+            }
+        }
+
+        sigma *= exp ((cs / damps) * (psNorm / chiN - 1.0));
+
+        matrix = C;
+        calculateEigen (matrix, B, eigenValues, n);
+        double maxD = 0;
+        for (int j = 0; j < n; ++j)
+        {
+            D[j] = sqrt (std::max (eigenValues[j], 1e-20));
+            maxD = std::max (maxD, D[j]);
+        }
+
+        double seconds = (Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+        if (verbose)
+            std::cout << "Generation " << generation + 1 << ": best distance " << String (bestDistance, 4) << " (this generation "
+                      << String (jobs[order[0]]->distance, 4) << "), step size " << String (sigma * maxD, 4) << ", "
+                      << numEvaluations << " renders in " << String (seconds, 1) << " s" << std::endl;
+
+        if (sigma * maxD < stepSizeTolerance || (maxSeconds > 0 && seconds > maxSeconds))
+            break;
+    }
+    return bestDistance;
+}
+
+void ParameterEstimator::calculateEigen (std::vector<double>& matrix, std::vector<double>& vectors, std::vector<double>& values, int n)
+{
+    std::fill (vectors.begin(), vectors.end(), 0.0);
+    for (int i = 0; i < n; ++i)
+        vectors[i * n + i] = 1.0;
+
+    // cyclic Jacobi: every rotation zeroes matrix[p][q]
+    for (int sweep = 0; sweep < 50; ++sweep)
+    {
+        double offDiagonal = 0, diagonal = 0;
+        for (int p = 0; p < n; ++p)
+        {
+            diagonal += matrix[p * n + p] * matrix[p * n + p];
+            for (int q = p + 1; q < n; ++q)
+                offDiagonal += matrix[p * n + q] * matrix[p * n + q];
+        }
+        if (offDiagonal <= 1e-30 * diagonal)
+            break;
+
+        for (int p = 0; p < n; ++p)
+        {
+            for (int q = p + 1; q < n; ++q)
+            {
+                double apq = matrix[p * n + q];
+                if (apq == 0)
+                    continue;
+
+                double theta = (matrix[q * n + q] - matrix[p * n + p]) / (2.0 * apq);
+                double t = (theta >= 0 ? 1.0 : -1.0) / (std::abs (theta) + sqrt (theta * theta + 1.0));
+                double c = 1.0 / sqrt (t * t + 1.0);
+                double s = t * c;
+
+                for (int r = 0; r < n; ++r)
+                {
+                    double arp = matrix[r * n + p];
+                    double arq = matrix[r * n + q];
+                    matrix[r * n + p] = c * arp - s * arq;
+                    matrix[r * n + q] = s * arp + c * arq;
+                }
+                for (int r = 0; r < n; ++r)
+                {
+                    double apr = matrix[p * n + r];
+                    double aqr = matrix[q * n + r];
+                    matrix[p * n + r] = c * apr - s * aqr;
+                    matrix[q * n + r] = s * apr + c * aqr;
+                }
+                for (int r = 0; r < n; ++r)
+                {
+                    double vrp = vectors[r * n + p];
+                    double vrq = vectors[r * n + q];
+                    vectors[r * n + p] = c * vrp - s * vrq;
+                    vectors[r * n + q] = s * vrp + c * vrq;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < n; ++i)
+        values[i] = matrix[i * n + i];
+}
+
+int ParameterEstimator::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+
+    File targetFile = File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--fit").unquoted());
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor (targetFile));
+    if (reader == nullptr)
+    {
+        std::cout << "Could not read " << targetFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    double fs = reader->sampleRate;
+    double duration = reader->lengthInSamples / fs;
+    double from = args.containsOption ("--from") ? args.getValueForOption ("--from").getDoubleValue() : 0.25 * duration;
+    double to = args.containsOption ("--to") ? args.getValueForOption ("--to").getDoubleValue() : 0.75 * duration;
+    int startSample = static_cast<int> (Global::limit (from, 0.0, duration) * fs);
+    int numSamples = static_cast<int> (Global::limit (to, 0.0, duration) * fs) - startSample;
+    if (numSamples < static_cast<int> (0.1 * fs))
+    {
+        std::cout << "The steady part of the target needs to be at least 0.1 s" << std::endl;
+        return 1;
+    }
+
+    // mixed to mono
+    AudioBuffer<float> buffer (static_cast<int> (reader->numChannels), numSamples);
+    reader->read (&buffer, 0, numSamples, startSample, true, true);
+    std::vector<float> target (numSamples, 0.0f);
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        for (int n = 0; n < numSamples; ++n)
+            target[n] += buffer.getReadPointer (ch)[n];
+
+    // the slide and temperature are those of the preset
+    TromboneParameters parameters;
+    String error;
+    if (args.containsOption ("--preset")
+        && !parameters.loadFromFile (File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--preset").unquoted()), error))
+    {
+        std::cout << "Could not load preset: " << error << std::endl;
+        return 1;
+    }
+
+    int numThreads = args.containsOption ("--threads") ? args.getValueForOption ("--threads").getIntValue() : SystemStats::getNumCpus();
+    ParameterEstimator estimator (parameters, fs, std::max (1, numThreads));
+    estimator.verbose = true;
+    if (args.containsOption ("--range"))
+        estimator.range = args.getValueForOption ("--range").getDoubleValue();
+    if (args.containsOption ("--seed"))
+        estimator.seed = args.getValueForOption ("--seed").getLargeIntValue();
+    if (!(estimator.range > 1.0))
+    {
+        std::cout << "The range needs to be larger than 1" << std::endl;
+        return 1;
+    }
+
+    String names = args.containsOption ("--params") ? args.getValueForOption ("--params") : "Pm,f0,Mr,sigmaR,H0,w,Sr,flare,x0,b";
+    if (!estimator.setFitParameters (StringArray::fromTokens (names, ",", ""), error)
+        || !estimator.setTarget (target.data(), numSamples, error))
+    {
+        std::cout << error << std::endl;
+        return 1;
+    }
+    std::cout << "Target pitch " << String (estimator.getTargetFeatures().pitch, 2) << " Hz" << std::endl;
+
+    int maxGenerations = args.containsOption ("--generations") ? args.getValueForOption ("--generations").getIntValue() : 100;
+    double startTime = Time::getMillisecondCounterHiRes();
+    double distance = estimator.run (maxGenerations);
+
+    std::cout << "Distance " << String (distance, 4) << " after " << estimator.getNumEvaluations() << " renders in "
+              << String ((Time::getMillisecondCounterHiRes() - startTime) * 0.001, 1) << " s" << std::endl;
+    const TromboneParameters& fitted = estimator.getBestParameters();
+    for (auto& name : estimator.getFitParameters())
+    {
+        double initial = 0, value = 0;
+        getValue (parameters, name, initial);
+        getValue (fitted, name, value);
+        std::cout << name << ": " << initial << " -> " << value << std::endl;
+    }
+
+    String outName = args.getValueForOption ("--out");
+    File outputFile = File::getCurrentWorkingDirectory().getChildFile (outName.isEmpty() ? "fitted.preset" : outName.unquoted());
+    if (!fitted.saveToFile (outputFile))
+    {
+        std::cout << "Could not write " << outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+//==============================================================================
+ParameterEstimator::Job::Job (ParameterEstimator& estimator, const TromboneParameters& parameters, const TromboneState& state) : ThreadPoolJob ("Trombone fit"),
+                                                                                                                                   estimator (estimator),
+                                                                                                                                   parameters (parameters),
+                                                                                                                                   state (state)
+{
+}
+
+ThreadPoolJob::JobStatus ParameterEstimator::Job::runJob()
+{
+    distance = estimator.evaluate (parameters, state, &finalState);
+    return jobHasFinished;
+}
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    ParameterEstimator.h
+    Created: 21 Oct 2026 8:37:14pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "Trombone.h"
+#include "TromboneParameters.h"
+#include "TromboneState.h"
+
+//==============================================================================
+/*
+    Offline fit of TromboneParameters to a recorded (sustained) tone.
+
+    The features of a tone are its pitch (YIN: the first dip of the cumulative
+    mean normalised difference function, refined by a parabola) and the levels
+    of its harmonics (averaged over frames of 0.1 s) in dB relative to their
+    mean, so the recording level doesn't matter. The distance between two
+    tones is the pitch difference in units of centsPerUnit squared plus the
+    rms level difference in units of dbPerUnit squared.
+
+    The fitted parameters are searched in log space, within a factor range of
+    their initial values (all need to be positive), with CMA-ES: every
+    generation is a population of candidates that are rendered headless in
+    parallel on a thread pool. Candidates warm start from the snapshot of the
+    best candidate so far (the lip and tube states, not the geometry, see
+    Trombone::setState()), so only a short settling time is rendered before
+    the analysis. Candidates that fail TromboneParameters::validate(), blow
+    up or don't speak get invalidDistance.
+
+    Usage: Trombone --fit=target.wav [--from=0.5] [--to=1.5] [--params=Pm,f0,Mr,sigmaR,H0,w,Sr,flare,x0,b]
+                    [--preset=start.preset] [--range=4] [--generations=100] [--threads=N] [--seed=1] [--out=fitted.preset]
+    where from and to select the steady part of the target [s] (by default the middle half).
+*/
+class ParameterEstimator
+{
+public:
+    struct Features
+    {
+        double pitch = 0;               // [Hz], 0 if the tone has no pitch
+        std::vector<double> levels;     // of the harmonics, relative to their mean [dB]
+    };
+
+    ParameterEstimator (const TromboneParameters& initialParameters, double fs, int numThreads);
+    ~ParameterEstimator();
+
+    // the names of TromboneParameters::forEachValue() to fit, fails if one doesn't exist or its initial value isn't positive
+    bool setFitParameters (const StringArray& names, String& error);
+    const StringArray& getFitParameters() { return fitNames; };
+
+    // value of a parameter by name, false if it doesn't exist
+    static bool getValue (TromboneParameters parameters, const String& name, double& value);
+
+    // the steady part of the target, fails if it has no pitch
+    bool setTarget (const float* samples, int numSamples, String& error);
+    const Features& getTargetFeatures() { return targetFeatures; };
+
+    static void analyse (const float* samples, int numSamples, double fs, int numHarmonics, Features& features);
+    double calculateDistance (const Features& features);
+
+    // renders a candidate (warm started from state if it isn't empty) and returns its distance to the target.
+    // The final state of the render is written to finalState if it isn't nullptr.
+    double evaluate (const TromboneParameters& parameters, const TromboneState& state, TromboneState* finalState);
+
+    // CMA-ES until maxGenerations, stepSizeTolerance or maxSeconds, returns the best distance
+    double run (int maxGenerations, double maxSeconds = 0);
+
+    const TromboneParameters& getBestParameters() { return bestParameters; };
+    double getBestDistance() { return bestDistance; };
+    int getNumEvaluations() { return numEvaluations; };
+
+    static int runFromCommandLine (const String& commandLine);
+
+    int numHarmonics = 16;
+    double centsPerUnit = 10.0;
+    double dbPerUnit = 3.0;
+    double invalidDistance = 1e6;
+
+    double range = 4.0;                 // the parameters are fitted in [initial / range, initial * range]
+    double initialStepSize = 0.3;       // in units of log (range)
+    double stepSizeTolerance = 1e-3;
+    int populationSize = 0;             // 0 for max (4 + 3 ln (number of parameters), number of threads)
+    int64 seed = 1;
+
+    bool warmStart = true;
+    double coldSettleTime = 0.5;        // [s] rendered before the analysis from rest
+    double warmSettleTime = 0.2;        // [s] rendered before the analysis from a snapshot
+    double maxAnalysisTime = 0.25;      // [s]
+
+    bool verbose = false;
+
+private:
+    class Job : public ThreadPoolJob
+    {
+    public:
+        Job (ParameterEstimator& estimator, const TromboneParameters& parameters, const TromboneState& state);
+        JobStatus runJob() override;
+
+        double distance = 0;
+        TromboneState finalState;
+
+    private:
+        ParameterEstimator& estimator;
+        TromboneParameters parameters;
+        TromboneState state;
+    };
+
+    // the parameters at a point of the search space (x = log (value / initial) / log (range), clipped to [-1, 1])
+    TromboneParameters getParameters (const std::vector<double>& x);
+
+    // eigendecomposition of a symmetric matrix (Jacobi rotations), the eigenvectors are the columns of vectors
+    static void calculateEigen (std::vector<double>& matrix, std::vector<double>& vectors, std::vector<double>& values, int n);
+
+    TromboneParameters initialParameters;
+    double fs, k;
+    int numThreads;
+
+    StringArray fitNames;
+    std::vector<double> initialValues;
+
+    Features targetFeatures;
+    int analysisLength = 0;
+
+    TromboneParameters bestParameters;
+    double bestDistance = 0;
+    TromboneState bestState;
+    int numEvaluations = 0;
+
+    ThreadPool pool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterEstimator)
+};
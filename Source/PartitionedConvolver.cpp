@@ -0,0 +1,234 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.cpp
+    Created: 20 Oct 2026 9:12:40am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PartitionedConvolver.h"
+
+//==============================================================================
+PartitionedConvolver::PartitionedConvolver (int blockSize, int maxKernelLength, int numSlots) : blockSize (blockSize),
+                                                                                                fftSize (2 * blockSize),
+                                                                                                numSlots (numSlots)
+{
+    jassert (isPowerOfTwo (blockSize));
+    maxPartitions = std::max (1, (maxKernelLength + blockSize - 1) / blockSize);
+
+    input.resize (fftSize, 0);
+    spectraRe.resize ((maxPartitions - 1) * fftSize, 0);
+    spectraIm.resize ((maxPartitions - 1) * fftSize, 0);
+
+    kernels.resize (numSlots, nullptr);
+    pendingKernels.resize (numSlots, nullptr);
+    tailsRe.resize (numSlots, std::vector<double> (blockSize, 0));
+    tailsIm.resize (numSlots, std::vector<double> (blockSize, 0));
+
+    bufferRe.resize (fftSize);
+    bufferIm.resize (fftSize);
+
+    twiddleRe.resize (fftSize / 2);
+    twiddleIm.resize (fftSize / 2);
+    for (int i = 0; i < fftSize / 2; ++i)
+    {
+        twiddleRe[i] = cos (2.0 * double_Pi * i / fftSize);
+        twiddleIm[i] = -sin (2.0 * double_Pi * i / fftSize);
+    }
+
+    int numBits = 0;
+    while ((1 << numBits) < fftSize)
+        ++numBits;
+    bitReversed.resize (fftSize);
+    for (int i = 0; i < fftSize; ++i)
+    {
+        int reversed = 0;
+        for (int b = 0; b < numBits; ++b)
+            if (i & (1 << b))
+                reversed |= 1 << (numBits - 1 - b);
+        bitReversed[i] = reversed;
+    }
+}
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+}
+
+void PartitionedConvolver::fft (double* re, double* im, bool inverse)
+{
+    for (int i = 0; i < fftSize; ++i)
+    {
+        int j = bitReversed[i];
+        if (j > i)
+        {
+            std::swap (re[i], re[j]);
+            std::swap (im[i], im[j]);
+        }
+    }
+
+    double sign = inverse ? -1.0 : 1.0;
+    for (int size = 2; size <= fftSize; size *= 2)
+    {
+        int half = size / 2;
+        int twiddleStep = fftSize / size;
+        for (int start = 0; start < fftSize; start += size)
+        {
+            for (int i = 0; i < half; ++i)
+            {
+                double wRe = twiddleRe[i * twiddleStep];
+                double wIm = sign * twiddleIm[i * twiddleStep];
+                int a = start + i;
+                int b = a + half;
+                double tRe = re[b] * wRe - im[b] * wIm;
+                double tIm = re[b] * wIm + im[b] * wRe;
+                re[b] = re[a] - tRe;
+                im[b] = im[a] - tIm;
+                re[a] += tRe;
+                im[a] += tIm;
+            }
+        }
+    }
+
+    if (inverse)
+    {
+        double oOSize = 1.0 / fftSize;
+        for (int i = 0; i < fftSize; ++i)
+        {
+            re[i] *= oOSize;
+            im[i] *= oOSize;
+        }
+    }
+}
+
+void PartitionedConvolver::prepareKernel (const std::vector<double>& re, const std::vector<double>& im, Kernel& kernel)
+{
+    jassert (re.size() == im.size() && static_cast<int> (re.size()) <= maxPartitions * blockSize);
+    int length = static_cast<int> (re.size());
+    kernel.numPartitions = std::max (1, (length + blockSize - 1) / blockSize);
+
+    // reversed, so that the head is a dot product with the input buffer
+    kernel.headRe.assign (blockSize, 0);
+    kernel.headIm.assign (blockSize, 0);
+    for (int m = 1; m < std::min (blockSize, length); ++m)
+    {
+        kernel.headRe[blockSize - m] = re[m];
+        kernel.headIm[blockSize - m] = im[m];
+    }
+
+    kernel.tailRe.assign ((kernel.numPartitions - 1) * fftSize, 0);
+    kernel.tailIm.assign ((kernel.numPartitions - 1) * fftSize, 0);
+    for (int p = 1; p < kernel.numPartitions; ++p)
+    {
+        double* partRe = &kernel.tailRe[(p - 1) * fftSize];
+        double* partIm = &kernel.tailIm[(p - 1) * fftSize];
+        for (int m = 0; m < blockSize && p * blockSize + m < length; ++m)
+        {
+            partRe[m] = re[p * blockSize + m];
+            partIm[m] = im[p * blockSize + m];
+        }
+        fft (partRe, partIm, false);
+    }
+}
+
+void PartitionedConvolver::getOutput (int slot, double& re, double& im)
+{
+    re = tailsRe[slot][pos];
+    im = tailsIm[slot][pos];
+
+    const Kernel* kernel = kernels[slot];
+    if (kernel == nullptr)
+        return;
+
+    // input[blockSize + pos - m] for taps m = 1 to blockSize - 1
+    const double* x = &input[pos + 1];
+    const double* headRe = &kernel->headRe[1];
+    const double* headIm = &kernel->headIm[1];
+    for (int m = 0; m < blockSize - 1; ++m)
+    {
+        re += headRe[m] * x[m];
+        im += headIm[m] * x[m];
+    }
+}
+
+bool PartitionedConvolver::push (double x)
+{
+    input[blockSize + pos] = x;
+    if (++pos < blockSize)
+        return false;
+
+    pos = 0;
+    for (int s = 0; s < numSlots; ++s)
+        kernels[s] = pendingKernels[s];
+
+    calculateTails();
+
+    // the current block becomes the previous one
+    std::copy (input.begin() + blockSize, input.end(), input.begin());
+    return true;
+}
+
+void PartitionedConvolver::calculateTails()
+{
+    if (maxPartitions < 2)
+        return;
+
+    // spectrum of the last two blocks into the delay line
+    spectraPos = spectraPos == 0 ? maxPartitions - 2 : spectraPos - 1;
+    double* newRe = &spectraRe[spectraPos * fftSize];
+    double* newIm = &spectraIm[spectraPos * fftSize];
+    std::copy (input.begin(), input.end(), newRe);
+    std::fill (newIm, newIm + fftSize, 0.0);
+    fft (newRe, newIm, false);
+
+    for (int s = 0; s < numSlots; ++s)
+    {
+        const Kernel* kernel = kernels[s];
+        if (kernel == nullptr)
+        {
+            std::fill (tailsRe[s].begin(), tailsRe[s].end(), 0.0);
+            std::fill (tailsIm[s].begin(), tailsIm[s].end(), 0.0);
+            continue;
+        }
+
+        std::fill (bufferRe.begin(), bufferRe.end(), 0.0);
+        std::fill (bufferIm.begin(), bufferIm.end(), 0.0);
+
+        // partition p meets the spectrum of p blocks ago
+        for (int p = 1; p < kernel->numPartitions; ++p)
+        {
+            int idx = (spectraPos + p - 1) % (maxPartitions - 1);
+            const double* xRe = &spectraRe[idx * fftSize];
+            const double* xIm = &spectraIm[idx * fftSize];
+            const double* hRe = &kernel->tailRe[(p - 1) * fftSize];
+            const double* hIm = &kernel->tailIm[(p - 1) * fftSize];
+            for (int i = 0; i < fftSize; ++i)
+            {
+                bufferRe[i] += xRe[i] * hRe[i] - xIm[i] * hIm[i];
+                bufferIm[i] += xRe[i] * hIm[i] + xIm[i] * hRe[i];
+            }
+        }
+
+        // overlap-save: the second half is the linear convolution
+        fft (bufferRe.data(), bufferIm.data(), true);
+        std::copy (bufferRe.begin() + blockSize, bufferRe.end(), tailsRe[s].begin());
+        std::copy (bufferIm.begin() + blockSize, bufferIm.end(), tailsIm[s].begin());
+    }
+}
+
+void PartitionedConvolver::reset()
+{
+    pos = 0;
+    for (int s = 0; s < numSlots; ++s)
+        kernels[s] = pendingKernels[s];
+    std::fill (input.begin(), input.end(), 0.0);
+    std::fill (spectraRe.begin(), spectraRe.end(), 0.0);
+    std::fill (spectraIm.begin(), spectraIm.end(), 0.0);
+    for (int s = 0; s < numSlots; ++s)
+    {
+        std::fill (tailsRe[s].begin(), tailsRe[s].end(), 0.0);
+        std::fill (tailsIm[s].begin(), tailsIm[s].end(), 0.0);
+    }
+}
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.h
+    Created: 20 Oct 2026 9:12:40am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Zero-latency convolution of a real input signal with long kernels: uniformly
+    partitioned overlap-save (blocks of blockSize samples) for the tail of the
+    kernels, and the first partition in the time domain.
+
+    The output of a sample only depends on the earlier inputs (tap 0 of the
+    kernels is ignored), so it can be read before the input of the same sample
+    is known, as needed to couple it to the lip model. Kernels are complex:
+    the real and imaginary part are two real kernels that share the FFTs.
+    Several slots (kernels) can run on the same input, e.g. to crossfade.
+
+    Only the constructor and prepareKernel() allocate.
+*/
+class PartitionedConvolver
+{
+public:
+    // blockSize needs to be a power of two
+    PartitionedConvolver (int blockSize, int maxKernelLength, int numSlots);
+    ~PartitionedConvolver();
+
+    class Kernel
+    {
+    public:
+        int getNumPartitions() const { return numPartitions; };
+
+    private:
+        friend class PartitionedConvolver;
+
+        int numPartitions = 0;
+        std::vector<double> headRe, headIm;    // taps 1 to blockSize - 1 (reversed)
+        std::vector<double> tailRe, tailIm;    // spectra of partitions 1 to numPartitions - 1
+    };
+
+    // re and im need to have the same length (at most maxKernelLength)
+    void prepareKernel (const std::vector<double>& re, const std::vector<double>& im, Kernel& kernel);
+
+    // takes effect at the start of the next block, nullptr disables the slot
+    void setKernel (int slot, const Kernel* kernel) { pendingKernels[slot] = kernel; };
+
+    // convolution of the earlier inputs with the kernel of a slot at the current sample
+    void getOutput (int slot, double& re, double& im);
+
+    // input of the current sample, moves on to the next sample. Returns true if a new block has started.
+    bool push (double x);
+
+    // clears the input and starts a new block (with the pending kernels)
+    void reset();
+
+    int getBlockSize() { return blockSize; };
+
+private:
+    // in-place radix-2 complex FFT
+    void fft (double* re, double* im, bool inverse);
+    void calculateTails();
+
+    int blockSize, fftSize, maxPartitions, numSlots;
+    int pos = 0;        // sample index in the current block
+
+    std::vector<double> input;              // previous and current block
+    std::vector<double> spectraRe, spectraIm;   // frequency domain delay line, (maxPartitions - 1) * fftSize
+    int spectraPos = 0;
+
+    std::vector<const Kernel*> kernels, pendingKernels;
+    std::vector<std::vector<double>> tailsRe, tailsIm;
+
+    std::vector<double> bufferRe, bufferIm;
+    std::vector<double> twiddleRe, twiddleIm;
+    std::vector<int> bitReversed;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PartitionedConvolver)
+};
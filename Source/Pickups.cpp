@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    Pickups.cpp
+    Created: 21 Oct 2026 9:02:48am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Pickups.h"
+
+//==============================================================================
+void Pickups::setTaps (const std::vector<Tap>& tapsToUse, int maxBlockSize, double pressureGain)
+{
+    taps = tapsToUse;
+    numTaps = static_cast<int> (taps.size());
+    gain = pressureGain;
+    blockSize = maxBlockSize;
+    block.assign (numTaps * blockSize, 0.0f);
+
+    for (auto* vec : { &source0, &index0, &source1, &index1 })
+        vec->assign (numTaps, 0);
+    weight0.assign (numTaps, 0);
+    weight1.assign (numTaps, 0);
+
+    // recalculated at the next gather()
+    readN = -1;
+    readM = -1;
+}
+
+void Pickups::calculateReads (Tube& tube)
+{
+    double N = tube.N;
+    double alf = N - tube.Nint;     // distance between up[M] and wp[0]
+    int M = tube.M;
+    int Mw = tube.Mw;
+
+    for (int t = 0; t < numTaps; ++t)
+    {
+        if (taps[t].type == lipDisplacement)
+        {
+            source0[t] = lip;
+            source1[t] = lip;
+            index0[t] = 0;
+            index1[t] = 0;
+            weight0[t] = 1.0;
+            weight1[t] = 0.0;
+            continue;
+        }
+
+        // position in grid points from the mouthpiece
+        double chi = taps[t].position / tube.h;
+        if (taps[t].type == pressureFromBell)
+            chi = N - chi;
+        chi = Global::limit (chi, 0.0, N);
+
+        double frac;
+        if (chi <= M)
+        {
+            int l = std::min (static_cast<int> (chi), M - 1);
+            frac = chi - l;
+            source0[t] = leftPressure;
+            source1[t] = leftPressure;
+            index0[t] = l;
+            index1[t] = l + 1;
+        }
+        else if (chi < M + alf)
+        {
+            // across the junction
+            frac = (chi - M) / alf;
+            source0[t] = leftPressure;
+            source1[t] = rightPressure;
+            index0[t] = M;
+            index1[t] = 0;
+        }
+        else
+        {
+            double chiW = chi - M - alf;
+            int l = std::min (static_cast<int> (chiW), Mw - 1);
+            frac = chiW - l;
+            source0[t] = rightPressure;
+            source1[t] = rightPressure;
+            index0[t] = l;
+            index1[t] = l + 1;
+        }
+        weight0[t] = gain * (1.0 - frac);
+        weight1[t] = gain * frac;
+    }
+
+    readN = tube.N;
+    readM = M;
+}
+
+void Pickups::copyToChannels (float* const* outputs, int numSamples)
+{
+    jassert (numSamples <= blockSize);
+    for (int t = 0; t < numTaps; ++t)
+    {
+        const float* src = block.data() + t;
+        for (int n = 0; n < numSamples; ++n)
+            outputs[t][n] = src[n * numTaps];
+    }
+}
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    Pickups.h
+    Created: 21 Oct 2026 9:02:48am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "Tube.h"
+#include "LipModel.h"
+
+//==============================================================================
+/*
+    Virtual microphones along the bore (and on the lip), as extra output
+    channels next to Tube::getOutput().
+
+    A pressure tap at a fractional position reads the two surrounding grid
+    points with linear interpolation. Across the junction the last point of
+    the left system (up[M]) and the first of the right system (wp[0]) are
+    alf = N - Nint apart instead of one. The reads (source, index, weight) are
+    only recalculated when the grid changes (slide or temperature), per
+    sample all taps are gathered in one loop over flat arrays into an
+    interleaved block, which copyToChannels() splits up at the end of the
+    block.
+
+    Call gather() after Trombone::calculate(): it reads the same time step as
+    Tube::getOutput(), so a pressureFromBell tap at 2 * h is the output.
+*/
+class Pickups
+{
+public:
+    enum Type
+    {
+        pressure = 0,       // position [m] from the mouthpiece (0 is the mouthpiece pressure)
+        pressureFromBell,   // position [m] from the bell end
+        lipDisplacement     // y [m], the position is ignored
+    };
+
+    struct Tap
+    {
+        Type type;
+        double position;
+    };
+
+    Pickups() {};
+
+    // allocates: not on the audio thread. The pressures are multiplied by pressureGain (the lip displacement isn't).
+    void setTaps (const std::vector<Tap>& tapsToUse, int maxBlockSize, double pressureGain = 1.0);
+    int getNumTaps() { return numTaps; };
+
+    void gather (Tube& tube, LipModel& lipModel, int sample)
+    {
+        if (tube.N != readN || tube.M != readM)
+            calculateReads (tube);
+
+        double lipY = lipModel.getY();
+        const double* sources[numSources] = { tube.up[1], tube.wp[1], &lipY };
+
+        float* dest = block.data() + sample * numTaps;
+        for (int t = 0; t < numTaps; ++t)
+            dest[t] = static_cast<float> (weight0[t] * sources[source0[t]][index0[t]] + weight1[t] * sources[source1[t]][index1[t]]);
+    };
+
+    // outputs[t] gets numSamples samples of tap t
+    void copyToChannels (float* const* outputs, int numSamples);
+
+private:
+    enum Source
+    {
+        leftPressure = 0,   // up
+        rightPressure,      // wp
+        lip,
+        numSources
+    };
+
+    void calculateReads (Tube& tube);
+
+    std::vector<Tap> taps;
+    int numTaps = 0;
+    double gain = 1.0;
+
+    std::vector<int> source0, index0, source1, index1;
+    std::vector<double> weight0, weight1;
+    float readN = -1;
+    int readM = -1;
+
+    std::vector<float> block;   // [sample * numTaps + tap]
+    int blockSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Pickups)
+};
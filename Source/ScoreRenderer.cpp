@@ -0,0 +1,274 @@
+/*
+  ==============================================================================
+
+    ScoreRenderer.cpp
+    Created: 19 Oct 2026 11:24:37am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ScoreRenderer.h"
+#include "Denormals.h"
+#include "ParameterEstimator.h"
+
+//==============================================================================
+ScoreRenderer::ScoreRenderer (double fs, int numThreads) : fs (fs), k (1.0 / fs), numThreads (numThreads)
+{
+    // the notes are played, so the lip drives the tube
+    defaultParameters.connectedToLip = true;
+
+    // slide from first (fully in) to seventh position (six semitones down)
+    L0 = defaultParameters.LnonExtended;
+    LMax = defaultParameters.getLmax();
+    c = Tube::calculateSpeedOfSound (defaultParameters.T);
+}
+
+ScoreRenderer::~ScoreRenderer()
+{
+}
+
+bool ScoreRenderer::loadMidiFile (const File& midiFile)
+{
+    FileInputStream stream (midiFile);
+    if (!stream.openedOk())
+        return false;
+
+    MidiFile midi;
+    if (!midi.readFrom (stream))
+        return false;
+    midi.convertTimestampTicksToSeconds();
+
+    notes.clear();
+    for (int i = 0; i < midi.getNumTracks(); ++i)
+    {
+        MidiMessageSequence track (*midi.getTrack (i));
+        track.updateMatchedPairs();
+        for (int e = 0; e < track.getNumEvents(); ++e)
+        {
+            auto* event = track.getEventPointer (e);
+            if (!event->message.isNoteOn() || event->noteOffObject == nullptr)
+                continue;
+
+            double start = event->message.getTimeStamp();
+            notes.push_back ({ start,
+                               event->noteOffObject->message.getTimeStamp() - start,
+                               event->message.getNoteNumber(),
+                               event->message.getFloatVelocity() });
+        }
+    }
+    std::sort (notes.begin(), notes.end(), [] (const Note& a, const Note& b) { return a.startTime < b.startTime; });
+    return !notes.empty();
+}
+
+void ScoreRenderer::mapNoteToSlide (double freq, double& L, double& f0)
+{
+    L = Tube::calculateSlideLength (freq, c, L0, LMax);
+    f0 = freq;
+}
+
+double ScoreRenderer::getPressure (const Note& note, double t)
+{
+    double Pm = maxPressure * note.velocity;
+    if (t < 0)
+        return 0;
+    if (t < attackTime)
+        return Pm * t / attackTime;
+    if (t < note.duration)
+        return Pm;
+    if (t < note.duration + releaseTime)
+        return Pm * (1.0 - (t - note.duration) / releaseTime);
+    return 0;
+}
+
+bool ScoreRenderer::render (const File& outputFile)
+{
+    if (notes.empty())
+        return false;
+
+    outputFile.deleteFile();
+    std::unique_ptr<FileOutputStream> stream (new FileOutputStream (outputFile));
+    if (!stream->openedOk())
+        return false;
+
+    WavAudioFormat wav;
+    std::unique_ptr<AudioFormatWriter> writer (wav.createWriterFor (stream.get(), fs, 1, 24, {}, 0));
+    if (writer == nullptr)
+        return false;
+    stream.release(); // the writer owns the stream now
+
+    double startTime = Time::getMillisecondCounterHiRes();
+
+    // the writer thread needs to outlive the threaded writer, which flushes on destruction
+    TimeSliceThread writerThread ("Trombone score writer");
+    writerThread.startThread();
+    std::unique_ptr<AudioFormatWriter::ThreadedWriter> threadedWriter (new AudioFormatWriter::ThreadedWriter (writer.release(), writerThread, 8 * chunkSize));
+
+    std::vector<std::unique_ptr<NoteRenderJob>> jobs;
+    int totNumSamples = 0;
+    for (auto& note : notes)
+    {
+        jobs.push_back (std::make_unique<NoteRenderJob> (*this, note));
+        totNumSamples = jmax (totNumSamples, jobs.back()->getStartSample() + static_cast<int> ((note.duration + releaseTime + tailTime) * fs));
+    }
+
+    {
+        // destroyed (and stopped) before the jobs it refers to
+        ThreadPool pool (numThreads);
+        for (auto& job : jobs)
+            pool.addJob (job.get(), false);
+
+        std::vector<float> chunk (chunkSize, 0);
+        int firstActiveJob = 0;
+
+        for (int chunkStart = 0; chunkStart < totNumSamples; chunkStart += chunkSize)
+        {
+            int chunkEnd = jmin (chunkStart + chunkSize, totNumSamples);
+            std::fill (chunk.begin(), chunk.end(), 0.0f);
+
+            for (int j = firstActiveJob; j < static_cast<int> (jobs.size()); ++j)
+            {
+                auto& job = jobs[j];
+                if (job->getStartSample() >= chunkEnd)
+                    break;
+
+                pool.waitForJobToFinish (job.get(), -1);
+
+                int from = jmax (chunkStart, job->getStartSample());
+                int to = jmin (chunkEnd, job->getStartSample() + job->getNumSamples());
+                for (int n = from; n < to; ++n)
+                    chunk[n - chunkStart] += job->getOutput()[n - job->getStartSample()];
+            }
+
+            // free the notes that have been written completely
+            while (firstActiveJob < static_cast<int> (jobs.size())
+                   && jobs[firstActiveJob]->getStartSample() + jobs[firstActiveJob]->getNumSamples() <= chunkEnd)
+            {
+                jobs[firstActiveJob]->clearOutput();
+                ++firstActiveJob;
+            }
+
+            const float* channels[] = { chunk.data() };
+            while (!threadedWriter->write (channels, chunkEnd - chunkStart))
+                Thread::sleep (1);
+        }
+    }
+
+    threadedWriter.reset();
+    writerThread.stopThread (1000);
+
+    renderTime = (Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+    renderedSeconds = totNumSamples / fs;
+    return true;
+}
+
+double ScoreRenderer::measurePitch (const Note& note)
+{
+    NoteRenderJob job (*this, note);
+    job.runJob();
+
+    // the held part after the attack has settled
+    int from = static_cast<int> ((attackTime + 0.2) * fs);
+    int to = static_cast<int> (note.duration * fs);
+    if (to - from < static_cast<int> (0.1 * fs))
+        return 0;
+
+    ParameterEstimator::Features features;
+    ParameterEstimator::analyse (job.getOutput() + from, to - from, fs, 1, features);
+    return features.pitch;
+}
+
+int ScoreRenderer::runCheck (double fs)
+{
+    // two notes a fifth apart need to come out at their own pitches (within a semitone)
+    ScoreRenderer renderer (fs, 1);
+    int failures = 0;
+    double prevPitch = 0;
+    for (int noteNumber : { 53, 60 })
+    {
+        Note note { 0.0, 1.0, noteNumber, 0.8f };
+        double expected = MidiMessage::getMidiNoteInHertz (noteNumber);
+        double pitch = renderer.measurePitch (note);
+        double cents = pitch > 0 ? 1200.0 * log2 (pitch / expected) : 0;
+        bool ok = pitch > 0 && std::abs (cents) < 100.0 && std::abs (pitch - prevPitch) > 1.0;
+        std::cout << "note " << noteNumber << ": " << String (pitch, 2) << " Hz (" << String (expected, 2) << " Hz, "
+                  << String (cents, 1) << " cents) " << (ok ? "ok" : "FAILED") << std::endl;
+        failures += ok ? 0 : 1;
+        prevPitch = pitch;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+int ScoreRenderer::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+
+    double fs = args.containsOption ("--fs") ? args.getValueForOption ("--fs").getDoubleValue() : 44100.0;
+    if (args.containsOption ("--check"))
+        return runCheck (fs);
+
+    File midiFile = File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--render").unquoted());
+    String outName = args.getValueForOption ("--out");
+    File outputFile = File::getCurrentWorkingDirectory().getChildFile (outName.isEmpty() ? "render.wav" : outName.unquoted());
+
+    int numThreads = args.containsOption ("--threads") ? args.getValueForOption ("--threads").getIntValue() : SystemStats::getNumCpus();
+
+    ScoreRenderer renderer (fs, numThreads);
+    if (!renderer.loadMidiFile (midiFile))
+    {
+        std::cout << "Could not read notes from " << midiFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    if (!renderer.render (outputFile))
+    {
+        std::cout << "Could not write " << outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Rendered " << renderer.getRenderedSeconds() << " s in " << renderer.getRenderTime() << " s ("
+              << renderer.getRealTimeFactor() << "x real-time, " << numThreads << " threads)" << std::endl;
+    return 0;
+}
+
+//==============================================================================
+ScoreRenderer::NoteRenderJob::NoteRenderJob (ScoreRenderer& renderer, const Note& note) : ThreadPoolJob ("Trombone note"),
+                                                                                           renderer (renderer),
+                                                                                           note (note)
+{
+    startSample = static_cast<int> (round (note.startTime * renderer.fs));
+}
+
+ThreadPoolJob::JobStatus ScoreRenderer::NoteRenderJob::runJob()
+{
+    double L, f0;
+    renderer.mapNoteToSlide (MidiMessage::getMidiNoteInHertz (note.noteNumber), L, f0);
+
+    TromboneParameters parameters = renderer.defaultParameters;
+    parameters.L = L;
+    parameters.f0 = f0;
+    parameters.Pm = 0;
+
+    Trombone trombone (parameters, renderer.k);
+
+    // the energy is not used here, only keep the loss integrators running
+    trombone.setEnergyInterval (std::numeric_limits<int>::max());
+
+    int numSamples = static_cast<int> ((note.duration + renderer.releaseTime + renderer.tailTime) * renderer.fs);
+    output.resize (numSamples, 0);
+
+    ScopedFlushToZero flushToZero;
+    for (int n = 0; n < numSamples; ++n)
+    {
+        if (n % renderer.controlInterval == 0)
+        {
+            trombone.setInputParams (renderer.getPressure (note, n * renderer.k), f0);
+            trombone.refreshLipModelInputParams();
+        }
+        trombone.calculate();
+        output[n] = trombone.getOutput() * 0.001 * Global::oOPressureMultiplier;
+        trombone.updateStates();
+    }
+    return jobHasFinished;
+}
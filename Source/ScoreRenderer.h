@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    ScoreRenderer.h
+    Created: 19 Oct 2026 11:24:37am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "Trombone.h"
+
+//==============================================================================
+/*
+    Offline (faster than real-time) renderer of a Standard MIDI File.
+
+    Every note is mapped to a slide length L (the shortest slide that puts one
+    of the resonances of the bore on the note), a lip frequency f0 and a
+    mouth pressure (Pm) envelope scaled by the velocity. As the slide can't
+    move within a single Trombone instance, every note (including its release
+    tail) is an independent job rendered on its own Trombone on a thread pool.
+    The notes are then mixed in time order and streamed to a wav file through
+    a writer on a background thread as soon as all notes overlapping a chunk
+    are done.
+
+    Usage: Trombone --render=score.mid --out=render.wav [--fs=44100] [--threads=N]
+           Trombone --render --check [--fs=44100]
+    where --check renders two notes and checks that they sound at their own pitches.
+*/
+class ScoreRenderer
+{
+public:
+    struct Note
+    {
+        double startTime;   // [s]
+        double duration;    // [s]
+        int noteNumber;
+        float velocity;     // [0, 1]
+    };
+
+    ScoreRenderer (double fs, int numThreads);
+    ~ScoreRenderer();
+
+    bool loadMidiFile (const File& midiFile);
+    void setNotes (const std::vector<Note>& notesToUse) { notes = notesToUse; };
+
+    bool render (const File& outputFile);
+
+    // find the slide length and lip frequency for a note
+    void mapNoteToSlide (double freq, double& L, double& f0);
+    double getPressure (const Note& note, double t);
+
+    // pitch of the held part of a note rendered on its own [Hz], 0 if it has none
+    double measurePitch (const Note& note);
+
+    double getRenderedSeconds() { return renderedSeconds; };
+    double getRenderTime() { return renderTime; };
+    double getRealTimeFactor() { return renderTime > 0 ? renderedSeconds / renderTime : 0; };
+
+    static int runFromCommandLine (const String& commandLine);
+    static int runCheck (double fs);
+
+    double attackTime = 0.02;       // [s]
+    double releaseTime = 0.05;      // [s]
+    double tailTime = 0.5;          // time after the release to let the tube ring out [s]
+    double maxPressure = 300 * Global::pressureMultiplier;
+    int controlInterval = 32;       // samples between updates of the input parameters
+    int chunkSize = 4096;
+
+private:
+    class NoteRenderJob : public ThreadPoolJob
+    {
+    public:
+        NoteRenderJob (ScoreRenderer& renderer, const Note& note);
+        JobStatus runJob() override;
+
+        int getStartSample() { return startSample; };
+        int getNumSamples() { return static_cast<int> (output.size()); };
+        const float* getOutput() { return output.data(); };
+        void clearOutput() { std::vector<float>().swap (output); };
+
+    private:
+        ScoreRenderer& renderer;
+        Note note;
+        int startSample;
+        std::vector<float> output;
+    };
+
+    double fs, k;
+    int numThreads;
+
+    TromboneParameters defaultParameters;
+    double L0, LMax, c;
+
+    std::vector<Note> notes;
+
+    double renderedSeconds = 0;
+    double renderTime = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ScoreRenderer)
+};
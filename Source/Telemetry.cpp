@@ -0,0 +1,238 @@
+/*
+  ==============================================================================
+
+    Telemetry.cpp
+    Created: 20 Oct 2026 10:26:40pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Telemetry.h"
+
+#if JUCE_MAC || JUCE_LINUX || JUCE_BSD
+ #define TROMBONE_POSIX_SHARED_MEMORY 1
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <fcntl.h>
+ #include <unistd.h>
+ #include <signal.h>
+ #include <cerrno>
+#else
+ #define TROMBONE_POSIX_SHARED_MEMORY 0
+#endif
+
+//==============================================================================
+String TelemetryPublisher::getDefaultName()
+{
+   #if TROMBONE_POSIX_SHARED_MEMORY
+    static std::atomic<int> numInstances { 0 };
+    int instance = numInstances++;
+    return "/trombone-" + String (static_cast<int> (getpid())) + (instance > 0 ? "-" + String (instance) : String());
+   #else
+    return {};
+   #endif
+}
+
+TelemetryPublisher::TelemetryPublisher (const String& nameToUse) : name (nameToUse.isEmpty() ? getDefaultName() : nameToUse)
+{
+   #if TROMBONE_POSIX_SHARED_MEMORY
+    // the seqlock needs a single writer, so the segment has to be new. One left behind by a process that
+    // has died (and didn't unlink it) is taken over.
+    int fd = shm_open (name.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST && !isOwnerAlive (name))
+    {
+        shm_unlink (name.toRawUTF8());
+        fd = shm_open (name.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0)
+        return;
+
+    if (ftruncate (fd, sizeof (TelemetrySegment)) == 0)
+    {
+        void* memory = mmap (nullptr, sizeof (TelemetrySegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (memory != MAP_FAILED)
+        {
+            // touch (and try to lock) the pages here so that the audio thread doesn't fault on them
+            std::memset (memory, 0, sizeof (TelemetrySegment));
+            mlock (memory, sizeof (TelemetrySegment));
+
+            segment = static_cast<TelemetrySegment*> (memory);
+            segment->ownerPid = static_cast<uint32> (getpid());
+            segment->version = TelemetrySegment::currentVersion;
+            segment->sequence.store (0, std::memory_order_relaxed);
+            std::atomic_thread_fence (std::memory_order_release);
+            segment->magic = TelemetrySegment::magicValue;
+        }
+    }
+    close (fd);
+
+    if (segment == nullptr)
+        shm_unlink (name.toRawUTF8());
+   #endif
+}
+
+TelemetryPublisher::~TelemetryPublisher()
+{
+   #if TROMBONE_POSIX_SHARED_MEMORY
+    if (segment != nullptr)
+    {
+        munmap (segment, sizeof (TelemetrySegment));
+        shm_unlink (name.toRawUTF8());
+    }
+   #endif
+}
+
+bool TelemetryPublisher::isOwnerAlive (const String& segmentName)
+{
+   #if TROMBONE_POSIX_SHARED_MEMORY
+    int fd = shm_open (segmentName.toRawUTF8(), O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+
+    // a segment that is still being set up (no magic yet) counts as alive
+    bool alive = true;
+    struct stat info;
+    if (fstat (fd, &info) == 0 && info.st_size >= static_cast<off_t> (sizeof (TelemetrySegment)))
+    {
+        void* memory = mmap (nullptr, sizeof (TelemetrySegment), PROT_READ, MAP_SHARED, fd, 0);
+        if (memory != MAP_FAILED)
+        {
+            auto* existing = static_cast<const TelemetrySegment*> (memory);
+            if (existing->magic == TelemetrySegment::magicValue)
+                alive = kill (static_cast<pid_t> (existing->ownerPid), 0) == 0 || errno != ESRCH;
+            munmap (memory, sizeof (TelemetrySegment));
+        }
+    }
+    close (fd);
+    return alive;
+   #else
+    ignoreUnused (segmentName);
+    return false;
+   #endif
+}
+
+void TelemetryPublisher::publish (const TelemetryData& data)
+{
+    if (segment == nullptr)
+        return;
+
+    // single writer: odd while the data is being written
+    uint32 sequence = segment->sequence.load (std::memory_order_relaxed);
+    segment->sequence.store (sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+    std::memcpy (&segment->data, &data, sizeof (TelemetryData));
+    segment->sequence.store (sequence + 2, std::memory_order_release);
+}
+
+void TelemetryPublisher::publish (TelemetryData& data, const float* output, int numSamples)
+{
+    float peak = 0;
+    double sumSquares = 0;
+    for (int n = 0; n < numSamples; ++n)
+    {
+        peak = jmax (peak, std::abs (output[n]));
+        sumSquares += output[n] * output[n];
+    }
+    data.peak = peak;
+    data.rms = numSamples > 0 ? sqrt (sumSquares / numSamples) : 0;
+    publish (data);
+}
+
+//==============================================================================
+TelemetryReader::TelemetryReader (const String& name)
+{
+   #if TROMBONE_POSIX_SHARED_MEMORY
+    int fd = shm_open (name.toRawUTF8(), O_RDONLY, 0);
+    if (fd < 0)
+        return;
+
+    struct stat info;
+    if (fstat (fd, &info) == 0 && info.st_size >= static_cast<off_t> (sizeof (TelemetrySegment)))
+    {
+        void* memory = mmap (nullptr, sizeof (TelemetrySegment), PROT_READ, MAP_SHARED, fd, 0);
+        if (memory != MAP_FAILED)
+        {
+            segment = static_cast<TelemetrySegment*> (memory);
+            if (segment->magic != TelemetrySegment::magicValue || segment->version != TelemetrySegment::currentVersion)
+            {
+                munmap (memory, sizeof (TelemetrySegment));
+                segment = nullptr;
+            }
+        }
+    }
+    close (fd);
+   #else
+    ignoreUnused (name);
+   #endif
+}
+
+TelemetryReader::~TelemetryReader()
+{
+   #if TROMBONE_POSIX_SHARED_MEMORY
+    if (segment != nullptr)
+        munmap (segment, sizeof (TelemetrySegment));
+   #endif
+}
+
+bool TelemetryReader::read (TelemetryData& data, int maxAttempts)
+{
+    if (segment == nullptr)
+        return false;
+
+    for (int attempt = 0; attempt < maxAttempts; ++attempt)
+    {
+        uint32 before = segment->sequence.load (std::memory_order_acquire);
+        if ((before & 1) != 0)
+            continue;
+
+        TelemetryData copy;
+        std::memcpy (&copy, &segment->data, sizeof (TelemetryData));
+        std::atomic_thread_fence (std::memory_order_acquire);
+
+        if (segment->sequence.load (std::memory_order_relaxed) == before)
+        {
+            data = copy;
+            return true;
+        }
+    }
+    return false;
+}
+
+//==============================================================================
+int TelemetryReader::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+    int instance = args.containsOption ("--instance") ? args.getValueForOption ("--instance").getIntValue() : 0;
+    String name = args.containsOption ("--name") ? args.getValueForOption ("--name").unquoted()
+                                                 : "/trombone-" + args.getValueForOption ("--pid").trim()
+                                                   + (instance > 0 ? "-" + String (instance) : String());
+    int interval = args.containsOption ("--interval") ? args.getValueForOption ("--interval").getIntValue() : 100;
+    int numLines = args.containsOption ("--count") ? args.getValueForOption ("--count").getIntValue() : 0;
+
+    TelemetryReader reader (name);
+    if (!reader.isOpen())
+    {
+        std::cout << "No telemetry segment " << name << " (start the instance first, or use --pid=<pid> [--instance=<n>] or --name=<name>)" << std::endl;
+        return 1;
+    }
+
+    std::cout << "block\tcallback [ms]\tload\tenergy\tpeak [kPa]\trms [kPa]\ty [m]\tPm [Pa]\tf0 [Hz]\trecoveries\tdisabled\txruns\tnear misses" << std::endl;
+
+    uint64 lastBlock = std::numeric_limits<uint64>::max();
+    for (int line = 0; numLines <= 0 || line < numLines;)
+    {
+        TelemetryData data;
+        if (reader.read (data) && data.blockIndex != lastBlock)
+        {
+            lastBlock = data.blockIndex;
+            std::cout << data.blockIndex << "\t" << data.callbackTime << "\t" << data.load << "\t" << data.energy << "\t"
+                      << data.peak << "\t" << data.rms << "\t" << data.y << "\t" << data.Pm << "\t" << data.f0 << "\t"
+                      << data.recoveries << "\t" << data.disabled << "\t" << data.xruns << "\t" << data.nearMisses << std::endl;
+            ++line;
+        }
+        Thread::sleep (interval);
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    Telemetry.h
+    Created: 20 Oct 2026 10:26:40pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Per-block metrics of a running instance, published through a POSIX
+    shared-memory segment so that they can be monitored from another process
+    (see TelemetryReader). By default the first publisher of a process uses
+    "/trombone-<pid>" and the following ones "/trombone-<pid>-<n>". The
+    segment is always created new (one writer per segment), a name that is
+    in use by a live process can't be opened.
+
+    The segment holds a single TelemetryData protected by a seqlock: the
+    audio thread makes the sequence odd, copies the data and makes it even
+    again, a reader retries until it saw the same even sequence before and
+    after its copy. Publishing never blocks and never makes a syscall, the
+    segment is created, sized and touched in the constructor.
+
+    Only depends on juce_core (so it can be used in the library as well). On
+    platforms without POSIX shared memory, isOpen() returns false and
+    publish() does nothing.
+*/
+struct TelemetryData
+{
+    uint64 blockIndex;
+    uint64 samplesProcessed;
+    double sampleRate;
+    double callbackTime;    // [ms]
+    double load;            // callback time / block duration
+    double energy;          // relative change of the total energy (Trombone::getScaledTotEnergy())
+    double peak;            // output of the block [kPa]
+    double rms;             // output of the block [kPa]
+    double y;               // lip opening [m]
+    double Pm;              // mouth pressure [Pa]
+    double f0;              // lip frequency [Hz]
+    int32 recoveries;       // instability watchdog trips
+    int32 disabled;         // 1 if the watchdog disabled the voice
+    int32 xruns;            // callbacks that took longer than the block
+    int32 nearMisses;       // callbacks that took more than 90% of the block
+};
+
+struct TelemetrySegment
+{
+    static const uint32 magicValue = 0x74726d62;    // "trmb"
+    static const uint32 currentVersion = 1;
+
+    uint32 magic;
+    uint32 version;
+    std::atomic<uint32> sequence;
+    uint32 ownerPid;
+    TelemetryData data;
+};
+
+static_assert (std::atomic<uint32>::is_always_lock_free, "the sequence is shared between processes");
+
+//==============================================================================
+class TelemetryPublisher
+{
+public:
+    // an empty name uses getDefaultName()
+    TelemetryPublisher (const String& name = {});
+    ~TelemetryPublisher();
+
+    bool isOpen() { return segment != nullptr; };
+    const String& getName() { return name; };
+
+    // wait-free, call from the audio thread
+    void publish (const TelemetryData& data);
+
+    // computes the output statistics for the block and publishes
+    void publish (TelemetryData& data, const float* output, int numSamples);
+
+    // unique per publisher (the pid and a counter)
+    static String getDefaultName();
+
+private:
+    // false if the segment doesn't exist or was left behind by a process that is gone
+    static bool isOwnerAlive (const String& segmentName);
+
+    String name;
+    TelemetrySegment* segment = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TelemetryPublisher)
+};
+
+//==============================================================================
+class TelemetryReader
+{
+public:
+    TelemetryReader (const String& name);
+    ~TelemetryReader();
+
+    bool isOpen() { return segment != nullptr; };
+
+    // false if the segment isn't open or the writer kept it busy for all attempts
+    bool read (TelemetryData& data, int maxAttempts = 1000);
+
+    // tails the segment of the instance with process id --pid (or --name), --interval ms between lines
+    static int runFromCommandLine (const String& commandLine);
+
+private:
+    TelemetrySegment* segment = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TelemetryReader)
+};
@@ -12,29 +12,28 @@
 #include "Trombone.h"
 
 //==============================================================================
-Trombone::Trombone (NamedValueSet& parameters, double k, std::vector<std::vector<double>>& geometry) : k (k),
-Pm (*parameters.getVarPointer ("Pm"))
+Trombone::Trombone (const TromboneParameters& parameters, double k) : k (k),
+Pm (parameters.Pm),
+LnonExtended (parameters.LnonExtended),
+nonlinearThreshold (parameters.nonlinearThreshold)
 {
-    // In your constructor, you should add any child components, and
-    // initialise any special settings that your component needs.
-    
-    tube = std::make_unique<Tube> (parameters, k, geometry);
-    addAndMakeVisible (tube.get());
-    lipModel = std::make_unique<LipModel> (parameters, k);
-    lipModel->setTubeParameters (tube->getH(),
-                                 tube->getRho(),
-                                 tube->getC(),
-                                 tube->getSBar(0),
-                                 tube->getSHalf(0));
-    addAndMakeVisible (lipModel.get());
-
-    massState.open ("massState.csv");
-    pState.open ("pState.csv");
-    vState.open ("vState.csv");
-    MSave.open ("MSave.csv");
-    MwSave.open ("MwSave.csv");
-    energySave.open ("energySave.csv");
+#if JUCE_DEBUG
+    String error;
+    if (!parameters.validate (k, error))
+    {
+        std::cout << "Invalid parameters: " << error << std::endl;
+        jassertfalse;
+    }
+#endif
 
+    tube = std::make_unique<Tube> (parameters, k);
+    lipModel = std::make_unique<LipModel> (parameters, k);
+    refreshLipModelTubeParameters();
+    tube->setNonlinear (nonlinearThreshold > 0 && parameters.Pm >= nonlinearThreshold);
+    
+    // 10 ms fade in after a recovery
+    fadeInStep = static_cast<float> (k / 0.01);
+    recoveryState.prepare (getMaxStateSize());
 }
 
 Trombone::~Trombone()
@@ -42,28 +41,16 @@ Trombone::~Trombone()
     closeFiles();
 }
 
-void Trombone::paint (juce::Graphics& g)
-{
-    /* This demo code just fills the component's background and
-       draws some placeholder text to get you started.
-
-       You should replace everything in this method with your own
-       drawing code..
-    */
-}
-
-void Trombone::resized()
-{
-    // This method is where you should set the bounds of any child
-    // components that your component contains..
-    Rectangle<int> totArea = getLocalBounds();
-    tube->setBounds (totArea.removeFromTop (getHeight() * 0.5));
-    lipModel->setBounds (totArea);
-
-}
-
 void Trombone::calculate()
 {
+    if (disabled)
+        return;
+    
+    bool tubeChanged = tube->updateL();
+    if (tube->updateAreas())
+        tubeChanged = true;
+    if (tubeChanged)
+        refreshLipModelTubeParameters();
     tube->calculateVelocity();
     lipModel->setTubeStates (tube->getP (1, 0), tube->getV (0, 0));
     lipModel->calculateCollision();
@@ -73,7 +60,73 @@ void Trombone::calculate()
     tube->calculatePressure();
     tube->calculateRadiation();
     
-    calculateEnergy();
+    if (energyCounter == 0)
+        calculateEnergy();
+    else
+        accumulateEnergyLosses();
+    
+    if (++energyCounter >= energyInterval)
+        energyCounter = 0;
+    
+    if (++watchdogCounter >= watchdogInterval)
+    {
+        watchdogCounter = 0;
+        checkStability();
+        
+        if (countSubnormals)
+        {
+            int num = tube->countSubnormals() + lipModel->countSubnormals();
+            if (num > 0)
+            {
+                numSubnormals += num;
+                DIAGNOSTIC_WARNING ("subnormal states", num);
+            }
+        }
+    }
+    
+    // fade in after a recovery
+    if (outputGain < 1.0f)
+        outputGain = std::min (1.0f, outputGain + fadeInStep);
+}
+
+void Trombone::checkStability()
+{
+    samplesSinceRecovery += watchdogInterval;
+    if (tube->isStable (pressureThreshold) && lipModel->isStable (lipThreshold))
+        return;
+    
+    ++numRecoveries;
+    
+    if (samplesSinceRecovery * k > 1.0)
+        recentRecoveries = 0;
+    samplesSinceRecovery = 0;
+    
+    // the states are only restored at the end of updateStates(), where the snapshots are taken, so that
+    // the swap doesn't make the stale buffers of the snapshot current. Mute this sample already.
+    outputGain = 0.0f;
+    recoveryPending = true;
+    
+    if (++recentRecoveries >= maxRecoveries)
+        disabled = true;
+}
+
+void Trombone::recover()
+{
+    outputGain = 0.0f;
+    if (recoveryState.isEmpty() || !setState (recoveryState))
+    {
+        tube->resetStates();
+        lipModel->resetStates();
+    }
+}
+
+void Trombone::refreshLipModelTubeParameters()
+{
+    lipModel->setTubeParameters (tube->getH(),
+                                 tube->getRho(),
+                                 tube->getC(),
+                                 tube->getSBar(0),
+                                 tube->getSHalf(0));
 }
 
 void Trombone::calculateEnergy()
@@ -86,14 +139,77 @@ void Trombone::calculateEnergy()
 //    std::cout << scaledTotEnergy << std::endl;
 }
 
+void Trombone::accumulateEnergyLosses()
+{
+    // the power and damping terms are integrated over time, so they need to be updated every sample
+    lipModel->getPower();
+    lipModel->getDampEnergy();
+    tube->getRadDampEnergy();
+}
+
 void Trombone::updateStates()
 {
     tube->updateStates();
     lipModel->updateStates();
+    
+    if (recoveryPending)
+    {
+        recoveryPending = false;
+        recover();
+    }
+}
+
+void Trombone::getState (TromboneState& state)
+{
+    state.data.resize (getStateSize());
+    double* dest = state.data.data();
+    *dest++ = scaledTotEnergy;
+    *dest++ = energyCounter;
+    dest = tube->writeState (dest);
+    lipModel->writeState (dest);
+}
+
+bool Trombone::setState (const TromboneState& state, bool keepGeometry)
+{
+    const double* src = state.data.data();
+    const double* end = src + state.data.size();
+    
+    // check the size using the header of the tube, so that nothing is changed if the state is incomplete
+    if (end - src < 9 || end - src != 2 + Tube::getStateSize (static_cast<int> (src[3]), static_cast<int> (src[4]), static_cast<int> (src[5])) + lipModel->getStateSize())
+        return false;
+    
+    double scaledTotEnergyIn = *src++;
+    int energyCounterIn = static_cast<int> (*src++);
+    
+    src = tube->readState (src, end, keepGeometry);
+    if (src == nullptr)
+        return false;
+    src = lipModel->readState (src, end);
+    if (src == nullptr)
+        return false;
+    
+    // the temperature might be different
+    refreshLipModelTubeParameters();
+    
+    scaledTotEnergy = scaledTotEnergyIn;
+    energyCounter = energyCounterIn % energyInterval;
+    return true;
 }
 
 void Trombone::saveToFiles()
 {
+    // only open the files when they are actually used, so that (headless) instances that don't save anything don't overwrite them
+    if (!filesOpened)
+    {
+        massState.open ("massState.csv");
+        pState.open ("pState.csv");
+        vState.open ("vState.csv");
+        MSave.open ("MSave.csv");
+        MwSave.open ("MwSave.csv");
+        energySave.open ("energySave.csv");
+        filesOpened = true;
+    }
+    
     massState << getLipOutput() << ";\n";
     
     for (int l = 0; l <= tube->getNint() + 1; ++l)
@@ -14,39 +14,116 @@
 #include "Global.h"
 #include "Tube.h"
 #include "LipModel.h"
+#include "TromboneState.h"
+#include "TromboneParameters.h"
 #include <fstream>
 //==============================================================================
 /*
 */
-class Trombone  : public juce::Component
+class Trombone
 {
 public:
-    Trombone (NamedValueSet& parameters, double k, std::vector<std::vector<double>>& geometry);
-    ~Trombone() override;
-
-    void paint (juce::Graphics&) override;
-    void resized() override;
+    Trombone (const TromboneParameters& parameters, double k);
+    ~Trombone();
 
     void calculate();
     void calculateEnergy();
+    void refreshLipModelTubeParameters();
+    void accumulateEnergyLosses();
+    
+    // calculate the full energy only every interval samples (the loss integrators still run every sample)
+    void setEnergyInterval (int interval) { energyInterval = interval < 1 ? 1 : interval; };
     
-    float getOutput() { return tube->getOutput(); };
+    float getOutput() { return tube->getOutput() * outputGain; };
     float getLipOutput() { return lipModel->getY(); };
     
     void saveToFiles();
     void closeFiles();
     void updateStates();
 
-    void refreshLipModelInputParams() { lipModel->refreshInputParams(); };
+    // snapshots of the full state, setState doesn't allocate and returns false if the state doesn't fit this instance.
+    // keepGeometry only takes the states (of a tube with the same grid), e.g. to warm start other bell parameters.
+    int getStateSize() { return 2 + tube->getStateSize() + lipModel->getStateSize(); };
+    int getMaxStateSize() { return 2 + tube->getMaxStateSize() + lipModel->getStateSize(); };
+    void getState (TromboneState& state);
+    bool setState (const TromboneState& state, bool keepGeometry = false);
+    
+    // Instability watchdog: every watchdogInterval samples the states are checked for NaN, inf and runaway values.
+    // If it trips, the voice is muted (hard: the states are already runaway, so there is nothing to fade out),
+    // reset to the recovery state (or zero if there is none) at the next updateStates() and faded back in.
+    // After maxRecoveries trips within a second, the voice stays muted (and isn't calculated) until resetWatchdog().
+    void checkStability();
+    void recover();
+    // copies into the snapshot reserved at construction, so it doesn't allocate on the audio thread
+    void setRecoveryState (const TromboneState& state) { recoveryState.data.assign (state.data.begin(), state.data.end()); };
+    void resetWatchdog() { disabled = false; recentRecoveries = 0; };
+    bool isDisabled() { return disabled; };
+    int getNumRecoveries() { return numRecoveries.load(); };
+    
+    // Diagnostic mode: count the subnormal values in the states at every watchdog check (also posted as a warning)
+    void setCountSubnormals (bool shouldCount) { countSubnormals = shouldCount; };
+    int64 getNumSubnormals() { return numSubnormals.load(); };
+    
+    int watchdogInterval = 64;
+    double pressureThreshold = 1e3 * 300 * Global::pressureMultiplier;
+    double lipThreshold = 0.1;
+    int maxRecoveries = 3;
+    
+    // also switches the convective term of the tube on or off (only loud notes pay for it)
+    void refreshLipModelInputParams()
+    {
+        lipModel->refreshInputParams();
+        tube->setNonlinear (nonlinearThreshold > 0 && lipModel->getPressureVal() >= nonlinearThreshold);
+    };
+    void setInputParams (double pressure, double lipFreq)
+    {
+        lipModel->setPressureVal (pressure);
+        lipModel->setLipFreqVal (lipFreq);
+    };
+    
+    void setPressure (double pressure) { lipModel->setPressureVal (pressure); };
+    void setLipFrequency (double lipFreq) { lipModel->setLipFreqVal (lipFreq); };
+    void setTargetL (double L) { tube->setTargetL (L); };
+    void setTemperature (double T) { tube->setTargetT (T); };
+    bool setAreas (double position, double length, const double* areas, int numAreas, bool fromBell = false)
+    {
+        return tube->setAreas (position, length, areas, numAreas, fromBell);
+    };
+    double getLnonExtended() { return LnonExtended; };
+    double getL() { return tube->getL(); };
+    double getT() { return tube->getT(); };
+    double getScaledTotEnergy() { return scaledTotEnergy; };
+    
+    // for the visualisation (see TromboneComponent)
+    Tube& getTube() { return *tube; };
+    LipModel& getLipModel() { return *lipModel; };
+    double getSlideLength (double freq) { return Tube::calculateSlideLength (freq, tube->getC(), LnonExtended, tube->getLMax()); };
     
 private:
     std::unique_ptr<Tube> tube;
     std::unique_ptr<LipModel> lipModel;
     
-    double k, Pm;
+    double k, Pm, LnonExtended, nonlinearThreshold;
     
     double scaledTotEnergy = 0;
     
+    int energyInterval = 1;
+    int energyCounter = 0;
+    
+    TromboneState recoveryState;
+    int watchdogCounter = 0;
+    int recentRecoveries = 0;
+    int samplesSinceRecovery = 0;
+    bool recoveryPending = false;
+    bool disabled = false;
+    float outputGain = 1.0f;
+    float fadeInStep;
+    std::atomic<int> numRecoveries { 0 };
+    
+    bool countSubnormals = false;
+    std::atomic<int64> numSubnormals { 0 };
+    
+    bool filesOpened = false;
     std::ofstream massState, pState, vState, MSave, MwSave, energySave;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Trombone)
 };
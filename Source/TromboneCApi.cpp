@@ -0,0 +1,349 @@
+/*
+  ==============================================================================
+
+    TromboneCApi.cpp
+    Created: 19 Oct 2026 8:40:12pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TromboneCApi.h"
+#include "Trombone.h"
+#include "Diagnostics.h"
+#include "Denormals.h"
+#include "Telemetry.h"
+#include "Pickups.h"
+
+//==============================================================================
+struct trombone_engine
+{
+    std::unique_ptr<Trombone> trombone;
+    TromboneState state;    // prepared for the largest state, so that saving and loading doesn't allocate
+    double fs;
+
+    uint64_t samplesProcessed = 0;
+    int64 totalTicks = 0;
+    double lastLoad = 0;
+    double maxLoad = 0;
+
+    std::unique_ptr<TelemetryPublisher> telemetry;
+    TelemetryData telemetryData {};
+
+    Pickups pickups;
+    int maxTapBlockSize = 0;
+};
+
+static const int energyInterval = 256;
+
+static TromboneParameters toTromboneParameters (const trombone_params& params)
+{
+    TromboneParameters parameters;
+    parameters.T = params.T;
+    parameters.Tmin = params.Tmin;
+    parameters.L = params.L;
+    parameters.LnonExtended = params.LnonExtended;
+    parameters.Lmax = params.Lmax;
+    for (int i = 0; i < TromboneParameters::numSections; ++i)
+    {
+        parameters.geometry[0][i] = params.lengths[i];
+        parameters.geometry[1][i] = params.radii[i];
+    }
+    parameters.flare = params.flare;
+    parameters.x0 = params.x0;
+    parameters.b = params.b;
+    parameters.f0 = params.f0;
+    parameters.Mr = params.Mr;
+    parameters.sigmaR = params.sigmaR;
+    parameters.H0 = params.H0;
+    parameters.barrier = params.barrier;
+    parameters.w = params.w;
+    parameters.Sr = params.Sr;
+    parameters.Kcol = params.Kcol;
+    parameters.alphaCol = params.alphaCol;
+    parameters.connectedToLip = params.connected_to_lip != 0;
+    parameters.Pm = params.Pm * Global::pressureMultiplier;
+    return parameters;
+}
+
+static void writeError (const String& message, char* error, size_t errorSize)
+{
+    if (error != nullptr && errorSize > 0)
+        message.copyToUTF8 (error, errorSize);
+}
+
+//==============================================================================
+int trombone_get_api_version (void)
+{
+    return TROMBONE_API_VERSION;
+}
+
+void trombone_default_params (trombone_params* params)
+{
+    if (params == nullptr)
+        return;
+
+    TromboneParameters parameters;
+    params->T = parameters.T;
+    params->Tmin = parameters.Tmin;
+    params->L = parameters.L;
+    params->LnonExtended = parameters.LnonExtended;
+    params->Lmax = parameters.Lmax;
+    for (int i = 0; i < TromboneParameters::numSections; ++i)
+    {
+        params->lengths[i] = parameters.geometry[0][i];
+        params->radii[i] = parameters.geometry[1][i];
+    }
+    params->flare = parameters.flare;
+    params->x0 = parameters.x0;
+    params->b = parameters.b;
+    params->f0 = parameters.f0;
+    params->Mr = parameters.Mr;
+    params->sigmaR = parameters.sigmaR;
+    params->H0 = parameters.H0;
+    params->barrier = parameters.barrier;
+    params->w = parameters.w;
+    params->Sr = parameters.Sr;
+    params->Kcol = parameters.Kcol;
+    params->alphaCol = parameters.alphaCol;
+    params->connected_to_lip = 1; // a host wants to play it (TromboneParameters defaults to the raised cosine of the visualisation)
+    params->Pm = parameters.Pm * Global::oOPressureMultiplier;
+}
+
+trombone_engine* trombone_create (const trombone_params* params, double sample_rate, char* error, size_t error_size)
+{
+    if (params == nullptr || !(sample_rate > 0))
+    {
+        writeError ("No parameters or invalid sample rate", error, error_size);
+        return nullptr;
+    }
+
+    TromboneParameters parameters = toTromboneParameters (*params);
+    String validationError;
+    if (!parameters.validate (1.0 / sample_rate, validationError))
+    {
+        writeError (validationError, error, error_size);
+        return nullptr;
+    }
+
+    // the host has no JUCE application to start the diagnostics thread
+    Diagnostics::start();
+
+    try
+    {
+        auto engine = std::make_unique<trombone_engine>();
+        engine->fs = sample_rate;
+        engine->trombone = std::make_unique<Trombone> (parameters, 1.0 / sample_rate);
+        engine->trombone->setEnergyInterval (energyInterval);
+        engine->state.prepare (engine->trombone->getMaxStateSize());
+        return engine.release();
+    }
+    catch (const std::bad_alloc&)
+    {
+        writeError ("Out of memory", error, error_size);
+        return nullptr;
+    }
+}
+
+void trombone_destroy (trombone_engine* engine)
+{
+    delete engine;
+}
+
+static void process (trombone_engine* engine, float* output, float* const* tapOutputs, int num_samples)
+{
+    int64 startTicks = Time::getHighResolutionTicks();
+    ScopedFlushToZero flushToZero;
+
+    auto& trombone = *engine->trombone;
+    trombone.refreshLipModelInputParams();
+    for (int n = 0; n < num_samples; ++n)
+    {
+        trombone.calculate();
+        output[n] = trombone.getOutput() * 0.001 * Global::oOPressureMultiplier;
+        if (tapOutputs != nullptr)
+            engine->pickups.gather (trombone.getTube(), trombone.getLipModel(), n);
+        trombone.updateStates();
+    }
+    if (tapOutputs != nullptr)
+        engine->pickups.copyToChannels (tapOutputs, num_samples);
+
+    int64 ticks = Time::getHighResolutionTicks() - startTicks;
+    engine->totalTicks += ticks;
+    engine->samplesProcessed += num_samples;
+    engine->lastLoad = Time::highResolutionTicksToSeconds (ticks) * engine->fs / num_samples;
+    engine->maxLoad = jmax (engine->maxLoad, engine->lastLoad);
+
+    if (engine->telemetry != nullptr)
+    {
+        auto& data = engine->telemetryData;
+        ++data.blockIndex;
+        data.samplesProcessed = engine->samplesProcessed;
+        data.sampleRate = engine->fs;
+        data.callbackTime = Time::highResolutionTicksToSeconds (ticks) * 1000.0;
+        data.load = engine->lastLoad;
+        data.energy = trombone.getScaledTotEnergy();
+        data.y = trombone.getLipModel().getY();
+        data.Pm = trombone.getLipModel().getPressureVal() * Global::oOPressureMultiplier;
+        data.f0 = trombone.getLipModel().getLipFreqVal();
+        data.recoveries = trombone.getNumRecoveries();
+        data.disabled = trombone.isDisabled() ? 1 : 0;
+        if (engine->lastLoad >= 1.0)
+            ++data.xruns;
+        else if (engine->lastLoad >= 0.9)
+            ++data.nearMisses;
+        engine->telemetry->publish (data, output, num_samples);
+    }
+}
+
+void trombone_process (trombone_engine* engine, float* output, int num_samples)
+{
+    if (engine == nullptr || output == nullptr || num_samples <= 0)
+        return;
+
+    process (engine, output, nullptr, num_samples);
+}
+
+int trombone_process_taps (trombone_engine* engine, float* output, float* const* tap_outputs, int num_samples)
+{
+    if (engine == nullptr || output == nullptr || num_samples <= 0)
+        return TROMBONE_ERROR_INVALID_ARGUMENT;
+    if (engine->pickups.getNumTaps() > 0 && (tap_outputs == nullptr || num_samples > engine->maxTapBlockSize))
+        return TROMBONE_ERROR_INVALID_ARGUMENT;
+
+    process (engine, output, engine->pickups.getNumTaps() > 0 ? tap_outputs : nullptr, num_samples);
+    return TROMBONE_OK;
+}
+
+void trombone_set_pressure (trombone_engine* engine, double pressure)
+{
+    if (engine != nullptr)
+        engine->trombone->setPressure (pressure * Global::pressureMultiplier);
+}
+
+void trombone_set_lip_frequency (trombone_engine* engine, double frequency)
+{
+    if (engine != nullptr)
+        engine->trombone->setLipFrequency (frequency);
+}
+
+void trombone_set_slide_length (trombone_engine* engine, double length)
+{
+    if (engine != nullptr)
+        engine->trombone->setTargetL (length);
+}
+
+void trombone_set_temperature (trombone_engine* engine, double temperature)
+{
+    if (engine != nullptr)
+        engine->trombone->setTemperature (temperature);
+}
+
+int trombone_set_areas (trombone_engine* engine, double position, double length, const double* areas, int num_areas, int from_bell)
+{
+    if (engine == nullptr || !engine->trombone->setAreas (position, length, areas, num_areas, from_bell != 0))
+        return TROMBONE_ERROR_INVALID_ARGUMENT;
+    return TROMBONE_OK;
+}
+
+double trombone_get_slide_length (trombone_engine* engine, double frequency)
+{
+    if (engine == nullptr || !(frequency > 0))
+        return 0;
+    return engine->trombone->getSlideLength (frequency);
+}
+
+size_t trombone_get_state_size (trombone_engine* engine)
+{
+    return engine == nullptr ? 0 : static_cast<size_t> (engine->trombone->getMaxStateSize());
+}
+
+int trombone_save_state (trombone_engine* engine, double* buffer, size_t buffer_size, size_t* size_written)
+{
+    if (engine == nullptr || buffer == nullptr)
+        return TROMBONE_ERROR_INVALID_ARGUMENT;
+
+    size_t size = static_cast<size_t> (engine->trombone->getStateSize());
+    if (buffer_size < size)
+        return TROMBONE_ERROR_BUFFER_TOO_SMALL;
+
+    engine->trombone->getState (engine->state);
+    std::copy (engine->state.data.begin(), engine->state.data.end(), buffer);
+    if (size_written != nullptr)
+        *size_written = size;
+    return TROMBONE_OK;
+}
+
+int trombone_load_state (trombone_engine* engine, const double* buffer, size_t size)
+{
+    if (engine == nullptr || buffer == nullptr)
+        return TROMBONE_ERROR_INVALID_ARGUMENT;
+
+    if (size > engine->state.data.capacity())
+        return TROMBONE_ERROR_INCOMPATIBLE_STATE;
+
+    engine->state.data.assign (buffer, buffer + size);
+    return engine->trombone->setState (engine->state) ? TROMBONE_OK : TROMBONE_ERROR_INCOMPATIBLE_STATE;
+}
+
+void trombone_get_stats (trombone_engine* engine, trombone_stats* stats)
+{
+    if (engine == nullptr || stats == nullptr)
+        return;
+
+    auto& trombone = *engine->trombone;
+    stats->samples_processed = engine->samplesProcessed;
+    stats->last_load = engine->lastLoad;
+    stats->max_load = engine->maxLoad;
+    stats->ns_per_sample = engine->samplesProcessed == 0 ? 0 : Time::highResolutionTicksToSeconds (engine->totalTicks) * 1e9 / engine->samplesProcessed;
+    stats->recoveries = trombone.getNumRecoveries();
+    stats->disabled = trombone.isDisabled() ? 1 : 0;
+    stats->L = trombone.getL();
+    stats->T = trombone.getT();
+    stats->energy = trombone.getScaledTotEnergy();
+}
+
+void trombone_reset_watchdog (trombone_engine* engine)
+{
+    if (engine != nullptr)
+        engine->trombone->resetWatchdog();
+}
+
+int trombone_enable_telemetry (trombone_engine* engine, const char* name)
+{
+    if (engine == nullptr)
+        return TROMBONE_ERROR_INVALID_ARGUMENT;
+
+    auto telemetry = std::make_unique<TelemetryPublisher> (name == nullptr ? String() : String::fromUTF8 (name));
+    if (!telemetry->isOpen())
+        return TROMBONE_ERROR_UNAVAILABLE;
+
+    engine->telemetry = std::move (telemetry);
+    return TROMBONE_OK;
+}
+
+int trombone_set_taps (trombone_engine* engine, const trombone_tap* taps, int num_taps, int max_block_size)
+{
+    if (engine == nullptr || num_taps < 0 || (num_taps > 0 && (taps == nullptr || max_block_size <= 0)))
+        return TROMBONE_ERROR_INVALID_ARGUMENT;
+
+    std::vector<Pickups::Tap> pickupTaps;
+    for (int t = 0; t < num_taps; ++t)
+    {
+        if (taps[t].type < TROMBONE_TAP_PRESSURE || taps[t].type > TROMBONE_TAP_LIP_DISPLACEMENT || !(taps[t].position >= 0))
+            return TROMBONE_ERROR_INVALID_ARGUMENT;
+        pickupTaps.push_back ({ static_cast<Pickups::Type> (taps[t].type), taps[t].position });
+    }
+
+    try
+    {
+        engine->pickups.setTaps (pickupTaps, max_block_size, 0.001 * Global::oOPressureMultiplier);
+        engine->maxTapBlockSize = max_block_size;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return TROMBONE_ERROR_INVALID_ARGUMENT;
+    }
+    return TROMBONE_OK;
+}
@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    TromboneCApi.h
+    Created: 19 Oct 2026 8:40:12pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+/*
+    Plain C interface of libtrombone (see Library/CMakeLists.txt), to embed the
+    trombone model in hosts that don't use JUCE.
+
+    All memory is allocated in trombone_create() (and the setup functions that
+    say they allocate), none of the other functions allocate or block, so they
+    can be called from the audio thread. An engine
+    is not thread-safe: call its functions from one thread at a time.
+
+    Pressures are in Pa. The setters take effect at the start of the next
+    trombone_process() call.
+*/
+
+#ifndef TROMBONE_C_API_H
+#define TROMBONE_C_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined (_WIN32)
+ #ifdef TROMBONE_BUILDING_LIBRARY
+  #define TROMBONE_API __declspec (dllexport)
+ #else
+  #define TROMBONE_API __declspec (dllimport)
+ #endif
+#else
+ #define TROMBONE_API __attribute__ ((visibility ("default")))
+#endif
+
+/* increased whenever the interface changes in an incompatible way */
+#define TROMBONE_API_VERSION 2
+
+#define TROMBONE_NUM_SECTIONS 6
+
+/* return values */
+#define TROMBONE_OK 0
+#define TROMBONE_ERROR_INVALID_ARGUMENT -1
+#define TROMBONE_ERROR_BUFFER_TOO_SMALL -2
+#define TROMBONE_ERROR_INCOMPATIBLE_STATE -3
+#define TROMBONE_ERROR_UNAVAILABLE -4
+
+typedef struct trombone_engine trombone_engine;
+
+/* same as TromboneParameters, initialise with trombone_default_params() */
+typedef struct trombone_params
+{
+    /* tube */
+    double T;               /* temperature [C] */
+    double Tmin;            /* lowest temperature that can be set at runtime [C] */
+    double L;               /* length of the tube (including slide extension) [m] */
+    double LnonExtended;    /* length of the tube with the slide fully in [m] */
+    double Lmax;            /* maximum slide extension, 0 for sqrt(2) * LnonExtended [m] */
+    double lengths[TROMBONE_NUM_SECTIONS];  /* [m] */
+    double radii[TROMBONE_NUM_SECTIONS];    /* [m] */
+    double flare;           /* bell flare (exponent coeff) */
+    double x0;              /* position of bell mouth (exponent coeff) */
+    double b;               /* bell fitting parameter */
+
+    /* lip */
+    double f0;              /* lip frequency [Hz] */
+    double Mr;              /* lip mass [kg] */
+    double sigmaR;          /* lip damping */
+    double H0;              /* lip equilibrium [m] */
+    double barrier;         /* collision barrier [m] */
+    double w;               /* lip width [m] */
+    double Sr;              /* lip area [m^2] */
+    double Kcol;            /* collision stiffness */
+    double alphaCol;        /* collision nonlinearity exponent */
+    int connected_to_lip;   /* 1: the lips drive the tube (default), 0: the tube rings from a raised cosine and the lips are silent */
+
+    /* input */
+    double Pm;              /* mouth pressure [Pa] */
+} trombone_params;
+
+typedef struct trombone_stats
+{
+    uint64_t samples_processed;
+    double last_load;       /* calculation time / duration of the last block */
+    double max_load;        /* highest load since creation */
+    double ns_per_sample;   /* average calculation time */
+    int recoveries;         /* number of times the instability watchdog reset the engine */
+    int disabled;           /* 1 if the watchdog disabled the engine (see trombone_reset_watchdog) */
+    double L;               /* current length of the tube [m] */
+    double T;               /* current temperature [C] */
+    double energy;          /* relative change of the total energy (updated every 256 samples) */
+} trombone_stats;
+
+TROMBONE_API int trombone_get_api_version (void);
+
+TROMBONE_API void trombone_default_params (trombone_params* params);
+
+/* returns NULL if the parameters are invalid for this sample rate, the reason is written to error (if not NULL) */
+TROMBONE_API trombone_engine* trombone_create (const trombone_params* params, double sample_rate, char* error, size_t error_size);
+TROMBONE_API void trombone_destroy (trombone_engine* engine);
+
+/* writes num_samples (mono) samples of the radiated pressure [kPa] to output */
+TROMBONE_API void trombone_process (trombone_engine* engine, float* output, int num_samples);
+
+/* virtual microphones along the bore (pressure [kPa], linearly interpolated between the grid points) and on the lip */
+#define TROMBONE_TAP_PRESSURE 0             /* position [m] from the mouthpiece (0 is the mouthpiece pressure) */
+#define TROMBONE_TAP_PRESSURE_FROM_BELL 1   /* position [m] from the bell end */
+#define TROMBONE_TAP_LIP_DISPLACEMENT 2     /* lip opening y [m], position is ignored */
+
+typedef struct trombone_tap
+{
+    int type;
+    double position;
+} trombone_tap;
+
+/* allocates: not from the audio thread. num_taps = 0 removes the taps */
+TROMBONE_API int trombone_set_taps (trombone_engine* engine, const trombone_tap* taps, int num_taps, int max_block_size);
+
+/* as trombone_process, tap_outputs[t] gets num_samples (at most max_block_size) samples of tap t */
+TROMBONE_API int trombone_process_taps (trombone_engine* engine, float* output, float* const* tap_outputs, int num_samples);
+
+TROMBONE_API void trombone_set_pressure (trombone_engine* engine, double pressure);
+TROMBONE_API void trombone_set_lip_frequency (trombone_engine* engine, double frequency);
+TROMBONE_API void trombone_set_slide_length (trombone_engine* engine, double length);        /* moves at most 5 m/s */
+TROMBONE_API void trombone_set_temperature (trombone_engine* engine, double temperature);    /* changes at most 10 C/s */
+TROMBONE_API double trombone_get_slide_length (trombone_engine* engine, double frequency);   /* shortest slide that plays frequency */
+
+/* changes the bore while playing (hand in the bell, mutes): the cross-sectional areas [m^2] between position and
+   position + length [m] from the mouthpiece (or from the bell end if from_bell is 1) become num_areas equally spaced
+   samples, areas[0] at position. Doesn't allocate; applied over the next samples (8 grid points per sample).
+   Returns TROMBONE_ERROR_INVALID_ARGUMENT if the range contains no grid point or an area isn't positive. */
+TROMBONE_API int trombone_set_areas (trombone_engine* engine, double position, double length, const double* areas, int num_areas, int from_bell);
+
+/* snapshots: trombone_get_state_size() is large enough for any slide position and temperature */
+TROMBONE_API size_t trombone_get_state_size (trombone_engine* engine);
+TROMBONE_API int trombone_save_state (trombone_engine* engine, double* buffer, size_t buffer_size, size_t* size_written);
+TROMBONE_API int trombone_load_state (trombone_engine* engine, const double* buffer, size_t size);
+
+TROMBONE_API void trombone_get_stats (trombone_engine* engine, trombone_stats* stats);
+TROMBONE_API void trombone_reset_watchdog (trombone_engine* engine);
+
+/* publishes per-block metrics to the POSIX shared-memory segment name (NULL for "/trombone-<pid>" for the first
+   engine of the process and "/trombone-<pid>-<n>" for the next ones), see Telemetry.h.
+   Allocates: call it after trombone_create(), not from the audio thread. Returns TROMBONE_ERROR_UNAVAILABLE
+   if the segment can't be created, e.g. when another engine or process uses the name (or on platforms without
+   POSIX shared memory). */
+TROMBONE_API int trombone_enable_telemetry (trombone_engine* engine, const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TROMBONE_C_API_H */
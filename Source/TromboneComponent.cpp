@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    TromboneComponent.cpp
+    Created: 19 Oct 2026 8:15:02pm
+    Author:  Silvin Willemsen
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TromboneComponent.h"
+
+//==============================================================================
+TromboneComponent::TromboneComponent (Trombone& trombone) : tubeComponent (trombone.getTube()),
+                                                           lipModelComponent (trombone.getLipModel())
+{
+    addAndMakeVisible (tubeComponent);
+    addAndMakeVisible (lipModelComponent);
+}
+
+TromboneComponent::~TromboneComponent()
+{
+}
+
+void TromboneComponent::paint (juce::Graphics& g)
+{
+}
+
+void TromboneComponent::resized()
+{
+    Rectangle<int> totArea = getLocalBounds();
+    tubeComponent.setBounds (totArea.removeFromTop (getHeight() * 0.5));
+    lipModelComponent.setBounds (totArea);
+}
@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    TromboneComponent.h
+    Created: 19 Oct 2026 8:15:02pm
+    Author:  Silvin Willemsen
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Trombone.h"
+#include "TubeComponent.h"
+#include "LipModelComponent.h"
+
+//==============================================================================
+/*
+    Visualisation of a Trombone: the tube on top and the lip model (input) below.
+    The Trombone itself doesn't depend on any of the GUI modules.
+*/
+class TromboneComponent  : public juce::Component
+{
+public:
+    TromboneComponent (Trombone& trombone);
+    ~TromboneComponent() override;
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+    TubeComponent tubeComponent;
+    LipModelComponent lipModelComponent;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TromboneComponent)
+};
@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    TromboneEngine.cpp
+    Created: 20 Oct 2026 5:03:22pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TromboneEngine.h"
+#include "Trombone.h"
+#include "FixedGridTrombone.h"
+#include "Denormals.h"
+
+//==============================================================================
+// the energy isn't used, only keep the loss integrators running (as ScoreRenderer)
+static void prepare (Trombone& trombone) { trombone.setEnergyInterval (std::numeric_limits<int>::max()); }
+static int getNint (Trombone& trombone) { return trombone.getTube().getNint(); }
+
+template <int Nint, int M>
+static void prepare (FixedGridTrombone<Nint, M>&) {}
+
+template <int Nint, int M>
+static int getNint (FixedGridTrombone<Nint, M>&) { return Nint; }
+
+static bool setTargetL (Trombone& trombone, double L) { trombone.setTargetL (L); return true; }
+static bool setTemperature (Trombone& trombone, double T) { trombone.setTemperature (T); return true; }
+static bool setAreas (Trombone& trombone, double position, double length, const double* areas, int numAreas, bool fromBell)
+{
+    return trombone.setAreas (position, length, areas, numAreas, fromBell);
+}
+
+// the grid (and the areas) of a FixedGridTrombone can't change
+template <int Nint, int M>
+static bool setTargetL (FixedGridTrombone<Nint, M>&, double) { jassertfalse; return false; }
+
+template <int Nint, int M>
+static bool setTemperature (FixedGridTrombone<Nint, M>&, double) { jassertfalse; return false; }
+
+template <int Nint, int M>
+static bool setAreas (FixedGridTrombone<Nint, M>&, double, double, const double*, int, bool) { jassertfalse; return false; }
+
+template <typename EngineType>
+class TromboneEngineImpl : public TromboneEngine
+{
+public:
+    TromboneEngineImpl (const TromboneParameters& parameters, double k) : engine (parameters, k) { prepare (engine); };
+
+    void setInputParams (double pressure, double lipFreq) override
+    {
+        engine.setInputParams (pressure, lipFreq);
+        engine.refreshLipModelInputParams();
+    };
+
+    void process (float* output, int numSamples) override
+    {
+        ScopedFlushToZero flushToZero;
+        for (int n = 0; n < numSamples; ++n)
+        {
+            engine.calculate();
+            output[n] = engine.getOutput();
+            engine.updateStates();
+        }
+    };
+
+    bool setTargetL (double L) override { return ::setTargetL (engine, L); };
+    bool setTemperature (double T) override { return ::setTemperature (engine, T); };
+    bool setAreas (double position, double length, const double* areas, int numAreas, bool fromBell) override
+    {
+        return ::setAreas (engine, position, length, areas, numAreas, fromBell);
+    };
+
+    int getNint() override { return ::getNint (engine); };
+    bool hasFixedGrid() override { return !std::is_same<EngineType, Trombone>::value; };
+
+private:
+    EngineType engine;
+};
+
+template <int Nint, int M>
+using FixedGridEngine = TromboneEngineImpl<FixedGridTrombone<Nint, M>>;
+
+//==============================================================================
+std::unique_ptr<TromboneEngine> TromboneEngine::create (const TromboneParameters& parameters, double k, int features)
+{
+    // the fixed grids only have the linear tube, with constant geometry
+    if (parameters.nonlinearThreshold > 0 || features != 0)
+        return createFallback (parameters, k);
+
+    // the sizes of the stock trombone (L = 2.658 m, T = 26.85 C)
+    Tube tube (parameters, k);
+    int Nint = tube.getNint();
+    int M = tube.getM();
+
+    if (Nint == 337 && M == 135)        // 44.1 kHz
+        return std::make_unique<FixedGridEngine<337, 135>> (parameters, k);
+    if (Nint == 367 && M == 147)        // 48 kHz
+        return std::make_unique<FixedGridEngine<367, 147>> (parameters, k);
+    if (Nint == 674 && M == 270)        // 88.2 kHz
+        return std::make_unique<FixedGridEngine<674, 270>> (parameters, k);
+    if (Nint == 734 && M == 294)        // 96 kHz
+        return std::make_unique<FixedGridEngine<734, 294>> (parameters, k);
+
+    return createFallback (parameters, k);
+}
+
+std::unique_ptr<TromboneEngine> TromboneEngine::createFallback (const TromboneParameters& parameters, double k)
+{
+    return std::make_unique<TromboneEngineImpl<Trombone>> (parameters, k);
+}
+
+int TromboneEngine::runFromCommandLine (const String& commandLine)
+{
+    ignoreUnused (commandLine);
+
+    TromboneParameters parameters;
+    bool identical = true;
+    for (double fs : { 44100.0, 48000.0, 88200.0, 96000.0 })
+    {
+        double k = 1.0 / fs;
+        auto fixed = create (parameters, k);
+        auto fallback = createFallback (parameters, k);
+
+        int numSamples = static_cast<int> (fs);
+        std::vector<float> fixedOutput (numSamples), fallbackOutput (numSamples);
+
+        auto measure = [numSamples] (TromboneEngine& engine, std::vector<float>& output) {
+            double start = Time::getMillisecondCounterHiRes();
+            for (int n = 0; n < numSamples; n += 512)
+                engine.process (output.data() + n, std::min (512, numSamples - n));
+            return (Time::getMillisecondCounterHiRes() - start) * 1e6 / numSamples;
+        };
+
+        double fallbackTime = measure (*fallback, fallbackOutput);
+        double fixedTime = measure (*fixed, fixedOutput);
+        bool same = fixedOutput == fallbackOutput;
+        identical = identical && same;
+
+        std::cout << "fs = " << fs << " Hz, " << fixed->getNint() << " intervals" << (fixed->hasFixedGrid() ? "" : " (no fixed grid)") << ": "
+                  << fallbackTime << " ns/sample, fixed grid: " << fixedTime << " ns/sample"
+                  << (same ? "" : " (output differs)") << std::endl;
+    }
+    return identical ? 0 : 1;
+}
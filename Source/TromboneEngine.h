@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    TromboneEngine.h
+    Created: 20 Oct 2026 5:03:22pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "TromboneParameters.h"
+
+//==============================================================================
+/*
+    A voice rendered in blocks.
+
+    create() returns a FixedGridTrombone if the grid of the parameters is one
+    of the compiled sizes (the stock trombone at 44.1, 48, 88.2 and 96 kHz)
+    and a Trombone otherwise. Both produce the same output. FixedGridTrombone
+    has no convective term and can't change its slide, temperature or areas,
+    so a nonlinearThreshold or any of the features the caller asks for gets a
+    Trombone.
+
+    Usage: Trombone --benchmark-fixed
+    compares both at the compiled sample rates.
+*/
+class TromboneEngine
+{
+public:
+    // what a caller uses besides the mouth pressure and lip frequency (combined for create())
+    enum Feature
+    {
+        slide = 1,
+        temperature = 2,
+        areas = 4
+    };
+
+    virtual ~TromboneEngine() {};
+
+    // applied at the next sample
+    virtual void setInputParams (double pressure, double lipFreq) = 0;
+    virtual void process (float* output, int numSamples) = 0;
+
+    // as Trombone, false if the engine doesn't have the feature (only if it wasn't asked for in create())
+    virtual bool setTargetL (double L) = 0;
+    virtual bool setTemperature (double T) = 0;
+    virtual bool setAreas (double position, double length, const double* areas, int numAreas, bool fromBell) = 0;
+
+    virtual int getNint() = 0;
+    virtual bool hasFixedGrid() = 0;
+
+    static std::unique_ptr<TromboneEngine> create (const TromboneParameters& parameters, double k, int features = 0);
+
+    // the runtime sized engine, regardless of the grid
+    static std::unique_ptr<TromboneEngine> createFallback (const TromboneParameters& parameters, double k);
+
+    static int runFromCommandLine (const String& commandLine);
+};
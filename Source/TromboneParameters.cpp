@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+    TromboneParameters.cpp
+    Created: 19 Oct 2026 3:55:48pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TromboneParameters.h"
+#include "Tube.h"
+
+//==============================================================================
+bool TromboneParameters::validate (double k, String& error) const
+{
+    auto fail = [&error] (const String& message) { error = message; return false; };
+
+    if (!(k > 0))
+        return fail ("k must be positive");
+
+    double c = Tube::calculateSpeedOfSound (T);
+    if (!(c > 0) || !(1 - 0.00335 * (T - 26.85) > 0))
+        return fail ("T out of range");
+    
+    if (Tmin > T || !(Tube::calculateSpeedOfSound (Tmin) > 0))
+        return fail ("Tmin out of range");
+
+    if (T > Tube::TMax)
+        return fail ("T can't be higher than " + String (Tube::TMax) + " C");
+
+    if (!(LnonExtended > 0) || !(L > 0))
+        return fail ("L and LnonExtended must be positive");
+
+    if (L > getLmax())
+        return fail ("L is larger than Lmax");
+
+    double totLength = 0;
+    for (int i = 0; i < numSections; ++i)
+    {
+        if (!(geometry[0][i] > 0) || !(geometry[1][i] > 0))
+            return fail ("Section " + String (i) + " needs a positive length and radius");
+        totLength += geometry[0][i];
+    }
+
+    if (!(flare > 0) || !(b > 0) || !(x0 > 0))
+        return fail ("flare, x0 and b must be positive");
+
+    // the tube chooses h = c * k / lambda at every temperature, so lambda is getLambda()
+    double lambda = getLambda();
+    if (lambda > 1.0 || !(lambda > 0))
+        return fail (nonlinearThreshold > 0 ? "Global::lambdaNonlinear out of range" : "Global::lambdaMax out of range");
+
+    // every section (but the slide, that can be extended) needs to be on the grid, also on the coarsest
+    // one (at the highest temperature that can be set at runtime)
+    double h = Tube::calculateSpeedOfSound (Tube::TMax) * k / lambda;
+    int NnonExtended = floor (LnonExtended / h);
+    for (int i = 0; i < numSections; ++i)
+        if (i != 1 && round (NnonExtended * geometry[0][i] / totLength) < 2)
+            return fail ("Section " + String (i) + " is shorter than two grid points (fs too low)");
+
+    if (!(Mr > 0) || !(H0 > 0) || sigmaR < 0 || Kcol < 0 || alphaCol < 1 || w < 0 || Sr < 0 || Pm < 0)
+        return fail ("Lip parameter out of range");
+
+    // the lips touch when y (the displacement from H0) goes below the barrier, not at rest
+    if (!(barrier < 0))
+        return fail ("barrier needs to be negative");
+
+    // stability of the (undamped) lip oscillator: omega0 * k < 2
+    if (!(f0 > 0) || 2.0 * double_Pi * f0 * k >= 2.0)
+        return fail ("f0 too high for the sample rate");
+
+    if (nonlinearThreshold < 0)
+        return fail ("nonlinearThreshold can't be negative");
+
+    return true;
+}
+
+bool TromboneParameters::loadFromFile (const File& file, String& error)
+{
+    if (!file.existsAsFile())
+    {
+        error = "Can't find " + file.getFullPathName();
+        return false;
+    }
+
+    TromboneParameters loaded;
+    StringArray lines = StringArray::fromLines (file.loadFileAsString());
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        String line = lines[i].upToFirstOccurrenceOf ("#", false, false).trim();
+        if (line.isEmpty())
+            continue;
+
+        String name = line.upToFirstOccurrenceOf ("=", false, false).trim();
+        String value = line.fromFirstOccurrenceOf ("=", false, false).trim();
+
+        bool found = false;
+        if (name == "lengths" || name == "radii")
+        {
+            StringArray values = StringArray::fromTokens (value, ", ", "");
+            values.removeEmptyStrings();
+            if (values.size() != numSections)
+            {
+                error = "Line " + String (i + 1) + ": " + name + " needs " + String (numSections) + " values";
+                return false;
+            }
+            auto& dest = loaded.geometry[name == "lengths" ? 0 : 1];
+            for (int s = 0; s < numSections; ++s)
+                dest[s] = values[s].getDoubleValue();
+            found = true;
+        }
+        else if (name == "connectedToLip")
+        {
+            loaded.connectedToLip = value.getIntValue() != 0;
+            found = true;
+        }
+        else
+        {
+            loaded.forEachValue ([&] (const char* paramName, double& param) {
+                if (name == paramName)
+                {
+                    param = value.getDoubleValue();
+                    found = true;
+                }
+            });
+        }
+
+        if (!found)
+        {
+            error = "Line " + String (i + 1) + ": unknown parameter " + name;
+            return false;
+        }
+    }
+
+    *this = loaded;
+    return true;
+}
+
+bool TromboneParameters::saveToFile (const File& file) const
+{
+    String text;
+    TromboneParameters copy = *this;
+    copy.forEachValue ([&text] (const char* paramName, double& param) {
+        text << paramName << " = " << String (param, 10) << "\n";
+    });
+    text << "connectedToLip = " << (connectedToLip ? 1 : 0) << "\n";
+
+    for (int g = 0; g < 2; ++g)
+    {
+        text << (g == 0 ? "lengths =" : "radii =");
+        for (int s = 0; s < numSections; ++s)
+            text << " " << String (geometry[g][s], 10);
+        text << "\n";
+    }
+    return file.replaceWithText (text);
+}
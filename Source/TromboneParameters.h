@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    TromboneParameters.h
+    Created: 19 Oct 2026 3:55:48pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+
+//==============================================================================
+/*
+    All parameters needed to construct a Trombone (Tube + LipModel). Plain
+    values with defaults, so constructing and copying them costs nothing.
+    Presets are text files with "name = value" lines (# starts a comment) that
+    only need to contain the values that differ from the defaults
+    (connectedToLip = 0 or 1).
+*/
+struct TromboneParameters
+{
+    static const int numSections = 6;
+
+    //// Tube ////
+    double T = 26.85;                       // temperature [C]
+    double Tmin = 0;                        // lowest temperature that can be set at runtime (sizes the grid) [C]
+    double L = 2.658;                       // length of the tube (including slide extension) [m]
+    double LnonExtended = 2.658;            // length of the tube with the slide fully in [m]
+    double Lmax = 0;                        // maximum slide extension, 0 for sqrt(2) * LnonExtended (seventh position) [m]
+
+    // Geometric information including formula from bell taken from T. Smyth "Trombone synthesis by model and measurement"
+    std::array<std::array<double, numSections>, 2> geometry {{
+        {{ 0.708, 0.177, 0.711, 0.306, 0.254, 0.502 }},     // lengths (changed fourth entry to account for bell length "error" in paper)
+        {{ 0.0069, 0.0072, 0.0069, 0.0071, 0.0075, 0.0107 }} // radii
+    }};
+
+    double flare = 0.7;                     // flare (exponent coeff)
+    double x0 = 0.0174;                     // position of bell mouth (exponent coeff)
+    double b = 0.0063;                      // fitting parameter
+
+    //// Lip ////
+    double f0 = 300.0;                      // fundamental freq lips
+    double Mr = 5.37e-5;                    // mass lips
+    double sigmaR = 5;                      // damping
+    double H0 = 2.9e-4;                     // equilibrium
+    double barrier = -2.9e-4;               // collision barrier
+    double w = 1e-2;                        // lip width
+    double Sr = 1.46e-5;                    // lip area
+    double Kcol = 10000;                    // collision stiffness
+    double alphaCol = 3;                    // collision nonlinearity exponent
+    bool connectedToLip = false;            // lip coupled to the tube, otherwise the tube rings from a raised cosine and the lip is silent
+
+    //// Input ////
+    double Pm = 300 * Global::pressureMultiplier;
+    double nonlinearThreshold = 0;          // mouth pressure (scaled as Pm) from which the tube is nonlinear (on a coarser grid, see getLambda()), 0 for always linear
+
+    // visits all scalar parameters by name (used for the presets)
+    template <typename Visitor>
+    void forEachValue (Visitor&& visit)
+    {
+        visit ("T", T);
+        visit ("Tmin", Tmin);
+        visit ("L", L);
+        visit ("LnonExtended", LnonExtended);
+        visit ("Lmax", Lmax);
+        visit ("flare", flare);
+        visit ("x0", x0);
+        visit ("b", b);
+        visit ("f0", f0);
+        visit ("Mr", Mr);
+        visit ("sigmaR", sigmaR);
+        visit ("H0", H0);
+        visit ("barrier", barrier);
+        visit ("w", w);
+        visit ("Sr", Sr);
+        visit ("Kcol", Kcol);
+        visit ("alphaCol", alphaCol);
+        visit ("Pm", Pm);
+        visit ("nonlinearThreshold", nonlinearThreshold);
+    }
+
+    double getLmax() const { return Lmax > 0 ? Lmax : LnonExtended * sqrt (2.0); };
+    
+    // the Courant number the tube chooses its grid for (h = c * k / lambda)
+    double getLambda() const { return nonlinearThreshold > 0 ? Global::lambdaNonlinear : Global::lambdaMax; };
+
+    // checks ranges and the stability of the schemes at time step k, the reason is written to error
+    bool validate (double k, String& error) const;
+
+    bool loadFromFile (const File& file, String& error);
+    bool saveToFile (const File& file) const;
+};
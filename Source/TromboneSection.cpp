@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    TromboneSection.cpp
+    Created: 23 Oct 2026 11:02:40am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TromboneSection.h"
+#include "Trombone.h"
+
+//==============================================================================
+template <int numLanes>
+static bool runSection (const TromboneParameters& parameters, double fs, int numSamples)
+{
+    double k = 1.0 / fs;
+    const int blockSize = 512;
+
+    // a chord of different notes and dynamics
+    double pressures[numLanes], lipFreqs[numLanes];
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        pressures[lane] = (200.0 + 50.0 * (lane % 5)) * Global::pressureMultiplier;
+        lipFreqs[lane] = 200.0 + 10.0 * lane;
+    }
+
+    std::vector<std::vector<float>> sectionOutput (numLanes, std::vector<float> (numSamples)), tromboneOutput = sectionOutput;
+
+    TromboneSection<numLanes> section (parameters, k);
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        section.setPressure (lane, pressures[lane]);
+        section.setLipFrequency (lane, lipFreqs[lane]);
+    }
+
+    double start = Time::getMillisecondCounterHiRes();
+    float* channels[numLanes];
+    for (int n = 0; n < numSamples; n += blockSize)
+    {
+        for (int lane = 0; lane < numLanes; ++lane)
+            channels[lane] = sectionOutput[lane].data() + n;
+        section.process (channels, std::min (blockSize, numSamples - n));
+    }
+    double sectionTime = (Time::getMillisecondCounterHiRes() - start) * 1e6 / (static_cast<double> (numSamples) * numLanes);
+
+    std::vector<std::unique_ptr<Trombone>> trombones;
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        trombones.push_back (std::make_unique<Trombone> (parameters, k));
+        trombones.back()->setEnergyInterval (std::numeric_limits<int>::max());
+        trombones.back()->setInputParams (pressures[lane], lipFreqs[lane]);
+        trombones.back()->refreshLipModelInputParams();
+    }
+
+    start = Time::getMillisecondCounterHiRes();
+    for (int n = 0; n < numSamples; n += blockSize)
+    {
+        ScopedFlushToZero flushToZero;
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            auto& trombone = *trombones[lane];
+            for (int i = n; i < std::min (n + blockSize, numSamples); ++i)
+            {
+                trombone.calculate();
+                tromboneOutput[lane][i] = trombone.getOutput();
+                trombone.updateStates();
+            }
+        }
+    }
+    double tromboneTime = (Time::getMillisecondCounterHiRes() - start) * 1e6 / (static_cast<double> (numSamples) * numLanes);
+
+    bool same = sectionOutput == tromboneOutput;
+    std::cout << numLanes << " lanes: " << tromboneTime << " ns per voice and sample with Trombones, "
+              << sectionTime << " with a TromboneSection" << (same ? "" : " (output differs)") << std::endl;
+    return same;
+}
+
+int TromboneSectionBenchmark::runFromCommandLine (const String& commandLine)
+{
+    ArgumentList args ("Trombone", commandLine);
+    double fs = args.containsOption ("--fs") ? args.getValueForOption ("--fs").getDoubleValue() : 44100.0;
+    double seconds = args.containsOption ("--seconds") ? args.getValueForOption ("--seconds").getDoubleValue() : 1.0;
+    if (!(fs > 0) || !(seconds > 0))
+    {
+        std::cout << "Invalid sample rate or duration" << std::endl;
+        return 1;
+    }
+
+    TromboneParameters parameters;
+    parameters.connectedToLip = true;
+
+    int numSamples = static_cast<int> (seconds * fs);
+    bool identical = runSection<4> (parameters, fs, numSamples);
+    identical = runSection<8> (parameters, fs, numSamples) && identical;
+    identical = runSection<16> (parameters, fs, numSamples) && identical;
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+/*
+  ==============================================================================
+
+    TromboneSection.h
+    Created: 19 Oct 2026 7:31:09pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "Tube.h"
+#include "TubeScheme.h"
+#include "LipModel.h"
+#include "Denormals.h"
+
+//==============================================================================
+/*
+    numLanes trombones with the same tube (geometry, length and temperature,
+    so the same grid) calculated in lockstep. The tube states are interleaved
+    per grid point ([l * numLanes + lane]), so the updates of the tube (see
+    TubeScheme, shared with Tube) are loops over all lanes that the compiler
+    turns into vector instructions. Every lane has its own LipModel, so its
+    own mouth pressure (Pm), lip frequency (f0) and lip state.
+
+    The slide, the temperature and the areas can't be changed, the tube is
+    always linear (nonlinearThreshold needs to be 0) and there is no energy
+    calculation or watchdog: use Trombone for that. With the same inputs, a
+    lane produces exactly the same output as a Trombone (checked by
+    TromboneSectionBenchmark).
+
+    The loops of a single Tube vectorise along the grid already, so this is
+    not necessarily faster: on an x86-64 test machine (44.1 kHz, SSE2 or AVX2)
+    4 lanes cost more per voice than 4 Trombones and 16 lanes two to three
+    times as much. Run the benchmark on the target before using it.
+*/
+template <int numLanes>
+class TromboneSection
+{
+public:
+    static_assert (numLanes == 4 || numLanes == 8 || numLanes == 16, "numLanes needs to be 4, 8 or 16");
+
+    using Lanes = std::array<double, numLanes>;
+
+    TromboneSection (const TromboneParameters& parameters, double k)
+    {
+        jassert (isSupported (parameters));
+
+        // use a Tube to calculate the grid, geometry, coefficients and initial states
+        Tube tube (parameters, k);
+
+        M = tube.M;
+        Mw = tube.Mw;
+        Nint = tube.Nint;
+        outputIdx = static_cast<int> (tube.N - 1);
+
+        lambdaOverRhoC = tube.lambdaOverRhoC;
+        rhoCLambda = tube.rho * tube.c * tube.lambda;
+        oOSBar = tube.oOSBar;
+        SHalf = tube.SHalf;
+
+        JunctionInterpolator::calculateCoefficients (tube.N - tube.Nint, ipOwn, ipOther);
+
+        z1 = tube.z1;
+        z2 = tube.z2;
+        z3 = tube.z3;
+        z4 = tube.z4;
+        oORadTerm = tube.oORadTerm;
+        kOver2Lr = k / (2.0 * tube.Lr);
+
+        for (int n = 0; n < 2; ++n)
+        {
+            upVecs[n].resize ((M + 1) * numLanes);
+            uvVecs[n].resize (M * numLanes);
+            wpVecs[n].resize ((Mw + 1) * numLanes);
+            wvVecs[n].resize (Mw * numLanes);
+            interleave (tube.up[n], M + 1, upVecs[n]);
+            interleave (tube.uv[n], M, uvVecs[n]);
+            interleave (tube.wp[n], Mw + 1, wpVecs[n]);
+            interleave (tube.wv[n], Mw, wvVecs[n]);
+            up[n] = upVecs[n].data();
+            uv[n] = uvVecs[n].data();
+            wp[n] = wpVecs[n].data();
+            wv[n] = wvVecs[n].data();
+        }
+
+        uvMPh.fill (tube.uvMPh);
+        wvmh.fill (tube.wvmh);
+        p1.fill (tube.p1);
+        v1.fill (tube.v1);
+
+        for (auto& lipModel : lipModels)
+        {
+            lipModel = std::make_unique<LipModel> (parameters, k);
+            lipModel->setTubeParameters (tube.h, tube.rho, tube.c, tube.SBar[0], tube.SHalf[0]);
+        }
+    }
+
+    // the grid can't change and the tube is linear
+    static bool isSupported (const TromboneParameters& parameters) { return parameters.nonlinearThreshold == 0; };
+
+    // the inputs are applied immediately
+    void setPressure (int lane, double pressure)
+    {
+        lipModels[lane]->setPressureVal (pressure);
+        lipModels[lane]->refreshInputParams();
+    };
+    void setLipFrequency (int lane, double lipFreq)
+    {
+        lipModels[lane]->setLipFreqVal (lipFreq);
+        lipModels[lane]->refreshInputParams();
+    };
+
+    // same order as Trombone::calculate()
+    void calculate()
+    {
+        TubeScheme::calculateVelocity<numLanes> (uv[0], uv[1], up[1], M, lambdaOverRhoC);
+        TubeScheme::calculateVelocity<numLanes> (wv[0], wv[1], wp[1], Mw, lambdaOverRhoC);
+        TubeScheme::calculateJunction<numLanes> (up[1], wp[1], M, ipOwn, ipOther, lambdaOverRhoC,
+                                                 uvMPh.data(), wvmh.data(), uvNextMPh.data(), wvNextmh.data());
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            auto& lipModel = *lipModels[lane];
+            lipModel.setTubeStates (up[1][lane], uv[0][lane]);
+            lipModel.calculateCollision();
+            lipModel.calculateDeltaP();
+            lipModel.calculate();
+            U[lane] = lipModel.getUb() + lipModel.getUr();
+        }
+
+        calculatePressure();
+
+        TubeScheme::calculateRadiation<numLanes> (wp[0] + Mw * numLanes, wp[1] + Mw * numLanes, wv[0] + (Mw - 1) * numLanes,
+                                                  v1.data(), p1.data(), v1Next.data(), p1Next.data(),
+                                                  rhoCLambda, SHalf[Nint-1], oOSBar[Nint], z1, z2, z3, z4, oORadTerm, kOver2Lr);
+    }
+
+    void updateStates()
+    {
+        std::swap (up[0], up[1]);
+        std::swap (uv[0], uv[1]);
+        std::swap (wp[0], wp[1]);
+        std::swap (wv[0], wv[1]);
+
+        uvMPh = uvNextMPh;
+        wvmh = wvNextmh;
+        p1 = p1Next;
+        v1 = v1Next;
+
+        for (auto& lipModel : lipModels)
+            lipModel->updateStates();
+    }
+
+    // the pressure at N - 1, as Tube::getOutput()
+    float getOutput (int lane)
+    {
+        return outputIdx <= M ? up[1][outputIdx * numLanes + lane] : wp[1][(outputIdx - M - 1) * numLanes + lane];
+    };
+
+    // calculates numSamples samples, output is [numLanes][numSamples]
+    void process (float* const* output, int numSamples)
+    {
+        ScopedFlushToZero flushToZero;
+        for (int n = 0; n < numSamples; ++n)
+        {
+            calculate();
+            for (int lane = 0; lane < numLanes; ++lane)
+                output[lane][n] = getOutput (lane);
+            updateStates();
+        }
+    }
+
+    int getNumLanes() { return numLanes; };
+    int getNint() { return Nint; };
+
+private:
+    void calculatePressure()
+    {
+        TubeScheme::calculatePressure<numLanes> (up[0], up[1], uv[0], 1, M, rhoCLambda, oOSBar.data(), SHalf.data());
+        TubeScheme::calculatePressure<numLanes> (wp[0], wp[1], wv[0], 1, Mw, rhoCLambda, oOSBar.data() + M, SHalf.data() + M);
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            // right (inner) boundary of left system
+            int i = M * numLanes + lane;
+            up[0][i] = TubeScheme::calculateBoundaryPressure (up[1][i], rhoCLambda, oOSBar[M], SHalf[M], uvNextMPh[lane], SHalf[M-1], uv[0][i - numLanes]);
+
+            // left (inner) boundary of right system
+            wp[0][lane] = TubeScheme::calculateBoundaryPressure (wp[1][lane], rhoCLambda, oOSBar[M], SHalf[M], wv[0][lane], SHalf[M-1], wvNextmh[lane]);
+
+            // excitation
+            up[0][lane] = TubeScheme::calculateExcitation (up[1][lane], rhoCLambda, oOSBar[0], U[lane], SHalf[0], uv[0][lane]);
+        }
+    }
+
+    void interleave (const double* source, int numPoints, std::vector<double>& dest)
+    {
+        for (int l = 0; l < numPoints; ++l)
+            for (int lane = 0; lane < numLanes; ++lane)
+                dest[l * numLanes + lane] = source[l];
+    }
+
+    int M, Mw, Nint, outputIdx;
+
+    // tube
+    double lambdaOverRhoC, rhoCLambda;
+    std::vector<double> oOSBar, SHalf;
+    double ipOwn[JunctionInterpolator::numOwn];
+    double ipOther[JunctionInterpolator::numOther];
+    double z1, z2, z3, z4, oORadTerm, kOver2Lr;
+
+    std::vector<double> upVecs[2], uvVecs[2], wpVecs[2], wvVecs[2];
+    double* up[2];
+    double* uv[2];
+    double* wp[2];
+    double* wv[2];
+
+    Lanes uvMPh, uvNextMPh, wvmh, wvNextmh;
+    Lanes p1, p1Next, v1, v1Next;
+
+    // lips
+    std::unique_ptr<LipModel> lipModels[numLanes];
+    Lanes U;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TromboneSection)
+};
+
+//==============================================================================
+/*
+    Usage: Trombone --benchmark-section [--fs=44100] [--seconds=1]
+    renders 4, 8 and 16 voices (different pressures and lip frequencies) with
+    a TromboneSection and with as many Trombones, compares the outputs and the
+    cost per voice.
+*/
+class TromboneSectionBenchmark
+{
+public:
+    static int runFromCommandLine (const String& commandLine);
+};
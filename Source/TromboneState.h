@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    TromboneState.h
+    Created: 19 Oct 2026 2:41:05pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Snapshot of the full state of a Trombone (tube states, junction values,
+    radiation, lip and energy integrators) as a flat array of doubles.
+
+    Trombone::getState() only allocates if the snapshot is too small (use
+    prepare() to avoid that), Trombone::setState() never allocates so it can
+    be used on the audio thread to warm start or fork a voice.
+*/
+class TromboneState
+{
+public:
+    TromboneState() {};
+
+    void prepare (int size) { data.reserve (size); };
+    void clear() { data.clear(); };
+    bool isEmpty() const { return data.empty(); };
+
+    std::vector<double> data;
+
+    bool writeToFile (const File& file) const
+    {
+        file.deleteFile();
+        FileOutputStream stream (file);
+        if (!stream.openedOk())
+            return false;
+
+        stream.writeInt (fileId);
+        stream.writeInt (version);
+        stream.writeInt (static_cast<int> (data.size()));
+        stream.write (data.data(), data.size() * sizeof (double));
+        stream.flush();
+        return true;
+    };
+
+    bool readFromFile (const File& file)
+    {
+        FileInputStream stream (file);
+        if (!stream.openedOk() || stream.readInt() != fileId || stream.readInt() != version)
+            return false;
+
+        // the stored size has to match the rest of the file before anything is allocated
+        int size = stream.readInt();
+        if (size <= 0 || size > std::numeric_limits<int>::max() / static_cast<int> (sizeof (double))
+            || stream.getNumBytesRemaining() != static_cast<int64> (size) * static_cast<int64> (sizeof (double)))
+            return false;
+
+        data.resize (size);
+        return stream.read (data.data(), size * static_cast<int> (sizeof (double))) == size * static_cast<int> (sizeof (double));
+    };
+
+    static const int fileId = 0x54524253; // "TRBS"
+    static const int version = 1;
+};
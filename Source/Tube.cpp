@@ -10,14 +10,18 @@
 
 #include <JuceHeader.h>
 #include "Tube.h"
+#include "Denormals.h"
 
 //==============================================================================
-Tube::Tube (NamedValueSet& parameters, double k, std::vector<std::vector<double>>& geometry) : k (k), L (*parameters.getVarPointer("L")), T (*parameters.getVarPointer("T"))
+Tube::Tube (const TromboneParameters& parameters, double k) : k (k), L (parameters.L), T (parameters.T), targetT (parameters.T), TMin (parameters.Tmin)
 {
     calculateThermodynamicConstants();
     
-    h = c * k;
-    NnonExtended = floor (static_cast<double>(*parameters.getVarPointer("LnonExtended")) / h);
+    // Courant number slightly below 1, as the interpolation at the junction makes the dynamic grid unstable at lambda = 1
+    // (and further below for the convective term, see calculateVelocityNonlinear())
+    lambdaGrid = parameters.getLambda();
+    h = c * k / lambdaGrid;
+    NnonExtended = floor (parameters.LnonExtended / h);
     
     N = L / h;
     if (Global::dontInterpolateAtStart)
@@ -27,8 +31,24 @@ Tube::Tube (NamedValueSet& parameters, double k, std::vector<std::vector<double>
     }
     Nint = floor(N);
 //    h = L / Nint;
+    targetL = L;
     
-    M = calculateGeometry (geometry, parameters);
+    // the slide can extend the tube up to LMax (by default six semitones down, i.e., seventh position)
+    LMax = std::max (parameters.getLmax(), L);
+    LMin = std::min (parameters.LnonExtended, L);
+    
+    // the grid is finest (most points) at the lowest temperature
+    NintMax = floor (LMax / (calculateSpeedOfSound (std::min (TMin, T)) * k / lambdaGrid)) + 1;
+    
+    // reserve everything that grows with the slide, so that moving it doesn't allocate
+    S.reserve (NintMax + 1);
+    SHalf.reserve (NintMax);
+    SBar.reserve (NintMax + 1);
+    oOSBar.reserve (NintMax + 1);
+    radii.reserve (NintMax);
+    pendingAreas.resize (NintMax + 1);
+    
+    M = calculateGeometry (parameters);
     Mw = Nint-M;
 
     calculateRadii();
@@ -47,15 +67,20 @@ Tube::Tube (NamedValueSet& parameters, double k, std::vector<std::vector<double>
 //    Mw = floor (N*0.5);
     for (int i = 0; i < 2; ++i)
     {
-        // need to change to proper sizes
-        uvVecs[i] = std::vector<double> (M, 0);
-        upVecs[i] = std::vector<double> (M+1, 0);
+        // need to change to proper sizes (the left system gets the points added by the slide)
+        uvVecs[i] = std::vector<double> (M + NintMax - Nint, 0);
+        upVecs[i] = std::vector<double> (M+1 + NintMax - Nint, 0);
         wvVecs[i] = std::vector<double> (Mw, 0);
         wpVecs[i] = std::vector<double> (Mw+1, 0);
 
     }
     
-    if (raisedCos || !Global::connectedToLip)
+    // the fluxes through the interfaces and the slopes (with a point beyond either end) of the largest system,
+    // see calculateVelocityNonlinear()
+    nonlinearFlux.resize (std::max (uvVecs[0].size(), wvVecs[0].size()) + 1, 0);
+    nonlinearSlopes.resize (nonlinearFlux.size() + 1, 0);
+    
+    if (raisedCos || !parameters.connectedToLip)
     {
         //        int start = N * 0.25 - 5;
         //        int end = N * 0.25 + 5;
@@ -92,26 +117,7 @@ Tube::Tube (NamedValueSet& parameters, double k, std::vector<std::vector<double>
     wpm1 = 0;
     
     // Radiation
-    R1 = rho * c;
-    rL = sqrt(SBar[Nint]) / (2.0 * double_Pi);
-    Lr = 0.613 * rho * rL;
-    R2 = 0.505 * rho * c;
-    Cr = 1.111 * rL / (rho * c * c);
-    
-    double zDiv = 2.0 * R1 * R2 * Cr + k * (R1 + R2);
-    if (zDiv == 0)
-    {
-        z1 = 0;
-        z2 = 0;
-    } else {
-        z1 = 2 * R2 * k / zDiv;
-        z2 = (2 * R1 * R2 * Cr - k * (R1 + R2)) / zDiv;
-    }
-    
-    z3 = k / (2.0 *Lr) + z1 / (2.0 * R2) + Cr * z1 / k;
-    z4 = (z2 + 1.0) / (2.0 * R2) + (Cr * z2 - Cr) / k;
-    
-    oORadTerm = 1.0 / (1.0 + rho * c * lambda * z3);
+    calculateRadiationCoefficients();
     
     p1 = 0;
     v1 = 0;
@@ -121,170 +127,155 @@ Tube::~Tube()
 {
 }
 
-void Tube::paint (juce::Graphics& g)
+void Tube::calculateThermodynamicConstants()
 {
-    /* This demo code just fills the component's background and
-       draws some placeholder text to get you started.
-
-       You should replace everything in this method with your own
-       drawing code..
-    */
-
-//    if (init)
-//    {
-        g.setColour (Colours::gold);
-        Path stringPathTop = drawGeometry (g, -1);
-        Path stringPathBottom = drawGeometry (g, 1);
-        g.strokePath (stringPathTop, PathStrokeType(2.0f));
-        g.strokePath (stringPathBottom, PathStrokeType(2.0f));
-        init = false;
-//    }
-    g.setColour (Colours::cyan);
-    Path state = visualiseState (g, (Global::setTubeTo1 ? 10000 : 0.01) * Global::oOPressureMultiplier);
-    g.strokePath (state, PathStrokeType (2.0f));
-
+    c = calculateSpeedOfSound (T);              // Speed of sound in air [m/s]
+    rho = calculateDensity (T);                 // Density of air [kg·m^{-3}]
+//    double deltaT = T - 26.85;
+//    eta = 1.846 * (1 + 0.0025 * deltaT);        // Shear viscosity [kg·s^{-1}·m^{-1}]
+//    nu = 0.8410 * (1 - 0.0002 * deltaT);        // Root of Prandtl number [-]
+//    gamma = 1.4017 * (1 - 0.00002 * deltaT);    // Ratio of specific heats [-]
     
-//    std::cout << "repainted" << std::endl;
-
 }
 
-Path Tube::drawGeometry (Graphics& g, int topOrBottom)
+void Tube::calculateRadiationCoefficients()
 {
-    double visualScaling = 1000.0;
-    Path stringPath;
-    stringPath.startNewSubPath (0, topOrBottom * radii[0] * visualScaling + getHeight() * 0.5);
-    int stateWidth = getWidth();
-    auto spacing = stateWidth / static_cast<double>(Nint - 1);
-    auto x = spacing;
-    
-    for (int y = 1; y < Nint; y++)
-    {
-        stringPath.lineTo(x, topOrBottom * radii[y] * visualScaling + getHeight() * 0.5);
-        x += spacing;
-    }
-    return stringPath;
+    calculateRadiationCircuit (SBar[Nint], rho, c, k, R1, R2, Lr, Cr, z1, z2, z3, z4);
+    oORadTerm = 1.0 / (1.0 + rho * c * lambda * z3);
 }
 
-Path Tube::visualiseState (Graphics& g, double visualScaling)
+void Tube::calculateRadiationCircuit (double SEnd, double rho, double c, double k, double& R1, double& R2, double& Lr, double& Cr,
+                                      double& z1, double& z2, double& z3, double& z4)
 {
-    auto stringBounds = getHeight() / 2.0;
-    Path stringPath;
-    stringPath.startNewSubPath (0, -up[1][0] * visualScaling + stringBounds);
-    int stateWidth = getWidth();
-    auto spacing = stateWidth / static_cast<double>(Nint - 1);
-    auto x = spacing;
-    bool switchToW = false;
-    
-    for (int y = 1; y <= Nint + 1; y++)
+    calculateRadiationCircuit (SEnd, rho, c, R1, R2, Lr, Cr);
+    
+    double zDiv = 2.0 * R1 * R2 * Cr + k * (R1 + R2);
+    if (zDiv == 0)
     {
-        float newY;
-        if (y <= M)
-        {
-            newY = -up[1][y] * visualScaling + stringBounds; // Needs to be -p, because a positive p would visually go down
-//            if (y == M-1)
-//            {
-//                std::cout << x;
-//            }
-            if (isnan(x) || isinf(abs(x) || isnan(up[1][y]) || isinf(abs(up[1][y]))))
-            {
-                std::cout << "Wait" << std::endl;
-            };
-            
-        } else {
-            if (!switchToW)
-            {
-                x -= spacing;
-                switchToW = true;
-            }
-            newY = -wp[1][y-M] * visualScaling + stringBounds; // Needs to be -p, because a positive p would visually go down
-//            if (y == M)
-//            {
-//                std::cout << ", " << x << std::endl;;
-//            }
-            if (isnan(x) || isinf(abs(x) || isnan(wp[1][y-M]) || isinf(abs(wp[1][y-M]))))
-            {
-                std::cout << "Wait" << std::endl;
-            };
-
-        }
-       
-        
-        if (isnan(newY))
-            newY = 0;
-        stringPath.lineTo (x, newY);
-        //        g.drawEllipse(x, newY, 2, 2, 5);
-        x += spacing;
+        z1 = 0;
+        z2 = 0;
+    } else {
+        z1 = 2 * R2 * k / zDiv;
+        z2 = (2 * R1 * R2 * Cr - k * (R1 + R2)) / zDiv;
     }
-    return stringPath;
-}
-
-void Tube::resized()
-{
-    // This method is where you should set the bounds of any child
-    // components that your component contains..
-
+    
+    z3 = k / (2.0 *Lr) + z1 / (2.0 * R2) + Cr * z1 / k;
+    z4 = (z2 + 1.0) / (2.0 * R2) + (Cr * z2 - Cr) / k;
 }
 
-void Tube::calculateThermodynamicConstants()
+void Tube::calculateRadiationCircuit (double SEnd, double rho, double c, double& R1, double& R2, double& Lr, double& Cr)
 {
-    double deltaT = T - 26.85;
-    c = 3.4723e2 * (1 + 0.00166 * deltaT);      // Speed of sound in air [m/s]
-    rho = 1.1769 * (1 - 0.00335 * deltaT);      // Density of air [kg·m^{-3}]
-//    eta = 1.846 * (1 + 0.0025 * deltaT);        // Shear viscosity [kg·s^{-1}·m^{-1}]
-//    nu = 0.8410 * (1 - 0.0002 * deltaT);        // Root of Prandtl number [-]
-//    gamma = 1.4017 * (1 - 0.00002 * deltaT);    // Ratio of specific heats [-]
-    
+    double rL = sqrt(SEnd) / (2.0 * double_Pi);
+    R1 = rho * c;
+    Lr = 0.613 * rho * rL;
+    R2 = 0.505 * rho * c;
+    Cr = 1.111 * rL / (rho * c * c);
 }
 
 void Tube::calculateVelocity()
 {
-    for (int l = 0; l < M; ++l)
-        uv[0][l] = uv[1][l] - lambdaOverRhoC * (up[1][l+1] - up[1][l]);
-    for (int l = 0; l < Mw; ++l)
-        wv[0][l] = wv[1][l] - lambdaOverRhoC * (wp[1][l+1] - wp[1][l]);
+    if (nonlinear)
+    {
+        // zero gradient at the mouthpiece and the bell, the junction velocities on the other side
+        calculateVelocityNonlinear (uv[0], uv[1], up[1], M, uv[1][0], uvMPh);
+        calculateVelocityNonlinear (wv[0], wv[1], wp[1], Mw, wvmh, wv[1][Mw-1]);
+    }
+    else
+    {
+        TubeScheme::calculateVelocity (uv[0], uv[1], up[1], M, lambdaOverRhoC);
+        TubeScheme::calculateVelocity (wv[0], wv[1], wp[1], Mw, lambdaOverRhoC);
+    }
     
     double alf = N - Nint;
-    std::vector<double> quadIp (3, 0);
-    quadIp[0] = -(alf - 1) / (alf + 1);
-    quadIp[1] = 1;
-    quadIp[2] = (alf - 1) / (alf + 1);
-    
-    upMP1 = up[1][M] * quadIp[2]  + wp[1][0] * quadIp[1] + wp[1][1] * quadIp[0];
-    wpm1 = up[1][M-1] * quadIp[0] + up[1][M] * quadIp[1]  + wp[1][0] * quadIp[2];
-
-    uvNextMPh = uvMPh - lambda / (rho * c) * (upMP1 - up[1][M]);
-    wvNextmh = wvmh - lambda / (rho * c) * (wp[1][0] - wpm1);
+    if (alf != ipAlf)
+    {
+        JunctionInterpolator::calculateCoefficients (alf, ipOwn, ipOther);
+        ipAlf = alf;
+    }
     
+    TubeScheme::calculateJunction (up[1], wp[1], M, ipOwn, ipOther, lambdaOverRhoC, &uvMPh, &wvmh, &uvNextMPh, &wvNextmh);
+}
 
+void Tube::calculateVelocityNonlinear (double* vNext, const double* v, const double* p, int num, double vLeft, double vRight)
+{
+    // The convective term in conservation form: the flux v^2 / 2 (in the same scaled units as the states, hence the
+    // pressureMultiplier) through the interfaces between the velocities. The velocities at either side of an interface are
+    // reconstructed with minmod limited slopes (MUSCL) and the flux is the local Lax-Friedrichs (Rusanov) one, so it is upwind
+    // at extrema and fronts and has almost no dissipation where the velocity is smooth. A central flux doesn't see the
+    // odd-even mode, which the term then grows until the tube blows up.
+    // The grid of a nonlinear tube (lambdaNonlinear) leaves c * (1 / lambda - 1) below the CFL limit for the convection
+    // speed, well above the particle velocities of the lip model at fortissimo. The flux turns linear above that, so that
+    // the tube stays stable when the velocities get higher (or when it is made nonlinear on a linear grid).
+    // Without branches and with the points next to the ends peeled off, so that all loops vectorise.
+    jassert (num > 1);
+    double vMax = c * Global::pressureMultiplier * (1.0 / lambda - 1.0);
+    double courant = lambda / (c * Global::pressureMultiplier);
+    double lambdaOverRhoC = this->lambdaOverRhoC; // not reloaded after every store to vNext
+    double* F = nonlinearFlux.data();
+    double* slopes = nonlinearSlopes.data() + 1;
+    
+    auto minmod = [] (double a, double b)
+    {
+        return jmax (0.0, jmin (a, b)) + jmin (0.0, jmax (a, b));
+    };
+    auto flux = [vMax] (double x)
+    {
+        // x^2 up to vMax (exactly, as |x| * (2 |x| - |x|) is), linear above
+        double absX = std::abs (x);
+        double cappedX = jmin (absX, vMax);
+        return cappedX * (2.0 * absX - cappedX);
+    };
+    
+    // the flux through an interface, from the velocities reconstructed at either side of it
+    auto interfaceFlux = [=] (double vL, double vR)
+    {
+        double a = jmin (vMax, jmax (std::abs (vL), std::abs (vR)));
+        return 0.25 * (flux (vL) + flux (vR)) - 0.5 * a * (vR - vL);
+    };
+    
+    // vLeft and vRight are repeated beyond the ends, so the slopes there are 0
+    slopes[-1] = 0;
+    slopes[0] = minmod (v[0] - vLeft, v[1] - v[0]);
+    for (int l = 1; l < num - 1; ++l)
+        slopes[l] = minmod (v[l] - v[l-1], v[l+1] - v[l]);
+    slopes[num-1] = minmod (v[num-1] - v[num-2], vRight - v[num-1]);
+    slopes[num] = 0;
+    
+    // F[l] is the flux through the interface left of v[l]
+    F[0] = interfaceFlux (vLeft, v[0] - 0.5 * slopes[0]);
+    for (int l = 1; l < num; ++l)
+        F[l] = interfaceFlux (v[l-1] + 0.5 * slopes[l-1], v[l] - 0.5 * slopes[l]);
+    F[num] = interfaceFlux (v[num-1] + 0.5 * slopes[num-1], vRight);
+    
+    for (int l = 0; l < num; ++l)
+        vNext[l] = v[l] - lambdaOverRhoC * (p[l+1] - p[l]) - courant * (F[l+1] - F[l]);
 }
 
 void Tube::calculatePressure()
 {
-    for (int l = 1; l < M; ++l) // calculate full range minus the boundaries
-        up[0][l] = up[1][l] - rho * c * lambda * oOSBar[l] * (SHalf[l] * uv[0][l] - SHalf[l-1] * uv[0][l-1]);
+    double rhoCLambda = rho * c * lambda;
+    
+    // calculate full range minus the boundaries
+    TubeScheme::calculatePressure (up[0], up[1], uv[0], 1, M, rhoCLambda, oOSBar.data(), SHalf.data());
     
     // right (inner) boundary of left system
-    up[0][M] = up[1][M] - rho * c * lambda * oOSBar[M] * (SHalf[M] * uvNextMPh - SHalf[M-1] * uv[0][M-1]);
+    up[0][M] = TubeScheme::calculateBoundaryPressure (up[1][M], rhoCLambda, oOSBar[M], SHalf[M], uvNextMPh, SHalf[M-1], uv[0][M-1]);
     
-    for (int l = 1; l < Mw; ++l) // calculate full range minus the boundaries
-        wp[0][l] = wp[1][l] - rho * c * lambda * oOSBar[l+M] * (SHalf[l+M] * wv[0][l] - SHalf[l-1+M] * wv[0][l-1]);
+    // calculate full range minus the boundaries
+    TubeScheme::calculatePressure (wp[0], wp[1], wv[0], 1, Mw, rhoCLambda, oOSBar.data() + M, SHalf.data() + M);
 
     // left (inner) boundary of right system
-    wp[0][0] = wp[1][0] - rho * c * lambda * oOSBar[M] * (SHalf[M] * wv[0][0] - SHalf[M-1] * wvNextmh);
+    wp[0][0] = TubeScheme::calculateBoundaryPressure (wp[1][0], rhoCLambda, oOSBar[M], SHalf[M], wv[0][0], SHalf[M-1], wvNextmh);
     
     // excitation
-    up[0][0] = up[1][0] - rho * c * lambda * oOSBar[0] * (-2.0 * (Ub + Ur) + 2.0 * SHalf[0] * uv[0][0]);
+    up[0][0] = TubeScheme::calculateExcitation (up[1][0], rhoCLambda, oOSBar[0], Ub + Ur, SHalf[0], uv[0][0]);
 //    std::cout << up[0][M-1] - wp[0][0] << std::endl;
 }
 
 void Tube::calculateRadiation()
 {
-    wp[0][Mw] = ((1.0 - rho * c * lambda * z3) * wp[1][Mw] - 2.0 * rho * c * lambda * (v1 + z4 * p1 - (SHalf[Nint-1] * wv[0][Mw-1]) * oOSBar[Nint])) * oORadTerm;
-
-    v1Next = v1 + k / (2.0 * Lr) * (wp[0][Mw] + wp[1][Mw]);
-    p1Next = z1 * 0.5 * (wp[0][Mw] + wp[1][Mw]) + z2 * p1;
-    if (v1Next != 0)
-        DBG("wait");
+    TubeScheme::calculateRadiation (&wp[0][Mw], &wp[1][Mw], &wv[0][Mw-1], &v1, &p1, &v1Next, &p1Next,
+                                    rho * c * lambda, SHalf[Nint-1], oOSBar[Nint], z1, z2, z3, z4, oORadTerm, k / (2.0 * Lr));
 }
 
 void Tube::updateStates()
@@ -312,8 +303,239 @@ void Tube::updateStates()
     v1 = v1Next;
 }
 
-int Tube::calculateGeometry (std::vector<std::vector<double>>& geometry, NamedValueSet& parameters)
+bool Tube::updateL()
 {
+    if (L == targetL && T == targetT)
+        return false;
+    
+    bool constantsChanged = false;
+    if (T != targetT)
+    {
+        // The grid spacing follows the wave speed (h = c * k / lambdaGrid) so the physical length stays the same
+        // and N changes, exactly like moving the slide. Only the coefficients depending on c and rho are updated.
+        double maxStep = maxTempChange * k;
+        T = targetT > T ? std::min (T + maxStep, targetT) : std::max (T - maxStep, targetT);
+        calculateThermodynamicConstants();
+        h = c * k / lambdaGrid;
+        lambdaOverRhoC = lambda / (rho * c);
+        calculateRadiationCoefficients();
+        constantsChanged = true;
+    }
+    
+    if (L != targetL)
+    {
+        double maxStep = maxSlideSpeed * k;
+        L = targetL > L ? std::min (L + maxStep, targetL) : std::max (L - maxStep, targetL);
+    }
+    N = L / h;
+    
+    // maxStep is (much) smaller than h, so N crosses at most one integer per sample
+    if (floor (N) > Nint)
+        addPoint();
+    else if (floor (N) < Nint)
+        removePoint();
+    
+    return constantsChanged;
+}
+
+void Tube::addPoint()
+{
+    // alf -> 1, so w_0 is at the location of u_{M+1} and the left system takes over its values
+    up[0][M+1] = wp[0][0];
+    up[1][M+1] = wp[1][0];
+    uv[0][M] = uvMPh;
+    uv[1][M] = uvMPh;
+    
+    ++M;
+    ++Nint;
+    
+    // alf = 0: u_M and w_0 now coincide
+    uvMPh = wv[1][0];
+    wvmh = uv[1][M-1];
+    
+    // extend the (cylindrical) tube at the junction, so that the existing points keep their cross-sectional area
+    S.insert (S.begin() + M, S[M-1]);
+    calculateAreas();
+    calculateRadii();
+}
+
+void Tube::removePoint()
+{
+    // u_M and w_0 coincide (alf = 0) so u_M can be removed, w_0 takes over their mean
+    for (int n = 0; n < 2; ++n)
+        wp[n][0] = 0.5 * (up[n][M] + wp[n][0]);
+    --M;
+    --Nint;
+    
+    // alf -> 1: the virtual points u_{M+1/2} and w_{-1/2} are both at the location of the removed velocity
+    uvMPh = uv[1][M];
+    wvmh = uv[1][M];
+    
+    S.erase (S.begin() + M + 1);
+    calculateAreas();
+    calculateRadii();
+}
+
+double Tube::calculateSlideLength (double freq, double c, double LnonExtended, double LMax)
+{
+    // The resonances of the bore are (approximately) at n * c / (2L). Use the shortest
+    // slide that puts a resonance on the note, which is the lowest possible partial n
+    // for which L is at least the length of the tube with the slide fully in.
+    int n = std::max (1, static_cast<int> (ceil (2.0 * LnonExtended * freq / c)));
+    
+    // notes in the gap between the pedal note and the second partial can't be reached
+    return std::min (n * c / (2.0 * freq), LMax);
+}
+
+bool Tube::isStable (double threshold)
+{
+    // !(|p| <= threshold) is also true for NaN, and a branchless reduction over the states vectorises
+    int unstable = 0;
+    for (int l = 0; l <= M; ++l)
+        unstable |= !(std::abs (up[0][l]) <= threshold);
+    for (int l = 0; l <= Mw; ++l)
+        unstable |= !(std::abs (wp[0][l]) <= threshold);
+    
+    unstable |= !(std::abs (p1Next) <= threshold) || !std::isfinite (v1Next);
+    return unstable == 0;
+}
+
+int Tube::countSubnormals()
+{
+    int count = 0;
+    for (int n = 0; n < 2; ++n)
+    {
+        count += Denormals::countSubnormals (up[n], M + 1);
+        count += Denormals::countSubnormals (uv[n], M);
+        count += Denormals::countSubnormals (wp[n], Mw + 1);
+        count += Denormals::countSubnormals (wv[n], Mw);
+    }
+    
+    double scalars[] = { uvMPh, uvNextMPh, wvmh, wvNextmh, p1, p1Next, v1, v1Next };
+    return count + Denormals::countSubnormals (scalars, static_cast<int> (std::size (scalars)));
+}
+
+void Tube::resetStates()
+{
+    for (int n = 0; n < 2; ++n)
+    {
+        std::fill (upVecs[n].begin(), upVecs[n].end(), 0.0);
+        std::fill (uvVecs[n].begin(), uvVecs[n].end(), 0.0);
+        std::fill (wpVecs[n].begin(), wpVecs[n].end(), 0.0);
+        std::fill (wvVecs[n].begin(), wvVecs[n].end(), 0.0);
+    }
+    uvMPh = 0;
+    uvNextMPh = 0;
+    wvmh = 0;
+    wvNextmh = 0;
+    upMP1 = 0;
+    wpm1 = 0;
+    
+    p1 = 0;
+    p1Next = 0;
+    v1 = 0;
+    v1Next = 0;
+    qHRadPrev = 0;
+}
+
+double* Tube::writeState (double* dest)
+{
+    *dest++ = h;
+    *dest++ = Nint;
+    *dest++ = M;
+    *dest++ = Mw;
+    *dest++ = L;
+    *dest++ = targetL;
+    *dest++ = N;
+    *dest++ = T;
+    *dest++ = targetT;
+    
+    // states in order of time (current first)
+    for (int n = 1; n >= 0; --n)
+    {
+        dest = std::copy (up[n], up[n] + M + 1, dest);
+        dest = std::copy (uv[n], uv[n] + M, dest);
+        dest = std::copy (wp[n], wp[n] + Mw + 1, dest);
+        dest = std::copy (wv[n], wv[n] + Mw, dest);
+    }
+    dest = std::copy (S.begin(), S.end(), dest);
+    
+    for (double val : { uvMPh, uvNextMPh, wvmh, wvNextmh, upMP1, wpm1, p1, p1Next, v1, v1Next,
+                        qHRadPrev, kinEnergy1, potEnergy1, radEnergy1 })
+        *dest++ = val;
+    
+    return dest;
+}
+
+const double* Tube::readState (const double* src, const double* end, bool keepGeometry)
+{
+    if (end - src < 9)
+        return nullptr;
+    
+    int NintIn = static_cast<int> (src[1]);
+    int MIn = static_cast<int> (src[2]);
+    int MwIn = static_cast<int> (src[3]);
+    double TIn = src[7];
+    
+    // the time step (and thereby the grid spacing at the temperature of the state) and the right system
+    // need to be the same, the left system needs to fit (see addPoint())
+    double hIn = calculateSpeedOfSound (TIn) * k / lambdaGrid;
+    if (std::abs (src[0] - hIn) > 1e-12 * hIn || TIn < TMin || MwIn != Mw || NintIn != MIn + MwIn
+        || MIn + 1 > static_cast<int> (upVecs[0].size()) || NintIn > NintMax || MIn < 1
+        || end - src < getStateSize (NintIn, MIn, MwIn) || (keepGeometry && NintIn != Nint))
+        return nullptr;
+    
+    M = MIn;
+    Nint = NintIn;
+    
+    L = src[4];
+    targetL = src[5];
+    N = src[6];
+    T = TIn;
+    targetT = src[8];
+    src += 9;
+    
+    calculateThermodynamicConstants();
+    h = c * k / lambdaGrid;
+    lambdaOverRhoC = lambda / (rho * c);
+    
+    
+    for (int n = 1; n >= 0; --n)
+    {
+        std::copy (src, src + M + 1, up[n]);
+        src += M + 1;
+        std::copy (src, src + M, uv[n]);
+        src += M;
+        std::copy (src, src + Mw + 1, wp[n]);
+        src += Mw + 1;
+        std::copy (src, src + Mw, wv[n]);
+        src += Mw;
+    }
+    
+    // doesn't allocate, as S has been reserved up to NintMax
+    if (!keepGeometry)
+    {
+        S.resize (Nint + 1);
+        std::copy (src, src + Nint + 1, S.begin());
+        numPendingAreas = 0;
+        calculateAreas();
+        calculateRadii();
+    }
+    src += Nint + 1;
+    
+    // depend on rho and c, so they change with the temperature of the state even if the geometry is kept
+    calculateRadiationCoefficients();
+    
+    for (double* val : { &uvMPh, &uvNextMPh, &wvmh, &wvNextmh, &upMP1, &wpm1, &p1, &p1Next, &v1, &v1Next,
+                         &qHRadPrev, &kinEnergy1, &potEnergy1, &radEnergy1 })
+        *val = *src++;
+    
+    return src;
+}
+
+int Tube::calculateGeometry (const TromboneParameters& parameters)
+{
+    auto& geometry = parameters.geometry;
     S.resize (Nint+1, 0);
     SHalf.resize (Nint, 0);
     SBar.resize (Nint+1, 0);
@@ -346,9 +568,9 @@ int Tube::calculateGeometry (std::vector<std::vector<double>>& geometry, NamedVa
 //    int m2tL = Nint * double (*parameters.getVarPointer ("m2tL"));
 //    int bellL = Nint * double (*parameters.getVarPointer ("bellL"));
     
-    double flare = *parameters.getVarPointer ("flare");
-    double x0 = *parameters.getVarPointer ("x0");
-    double b = *parameters.getVarPointer ("b");
+    double flare = parameters.flare;
+    double x0 = parameters.x0;
+    double b = parameters.b;
 
     if (Global::setTubeTo1)
     {
@@ -371,8 +593,9 @@ int Tube::calculateGeometry (std::vector<std::vector<double>>& geometry, NamedVa
             }
             if (idx == 4) // tuning slide
             {
+                // from the radius of this section to the one of the bell over its own lengthInN[idx] points
                 S[i] = pow(Global::linspace(geometry[1][idx], geometry[1][idx+1],
-                                        lengthInN[idx+1] -lengthInN[idx], i - curN - 1), 2) * double_Pi;
+                                        lengthInN[idx], i - curN - 1), 2) * double_Pi;
             } else if (idx == 5)
             {
                 double x = geometry[0][5] - geometry[0][5] * (i - (Nint - lengthInN[5]) - 1) / lengthInN[5];
@@ -396,27 +619,115 @@ int Tube::calculateGeometry (std::vector<std::vector<double>>& geometry, NamedVa
 //        }
     }
     
-    for (int i = 0; i < Nint; ++i)
-        SHalf[i] = (S[i] + S[i+1]) * 0.5;
+    calculateAreas();
     
-    SBar[0] = S[0];
+    return addPointsAt;
+}
+
+void Tube::calculateAreas()
+{
+    SHalf.resize (Nint, 0);
+    SBar.resize (Nint+1, 0);
+    oOSBar.resize (Nint+1, 0);
     
-    for (int i = 0; i < Nint - 1; ++i)
-        SBar[i+1] = (SHalf[i] + SHalf[i+1]) * 0.5;
+    calculateAreas (0, Nint);
+}
+
+void Tube::calculateAreas (int from, int to)
+{
+    // SHalf[i] depends on S[i] and S[i+1], SBar[i] on SHalf[i-1] and SHalf[i]
+    int lastHalf = std::min (to, Nint - 1);
+    for (int i = std::max (from - 1, 0); i <= lastHalf; ++i)
+        SHalf[i] = (S[i] + S[i+1]) * 0.5;
     
-    SBar[Nint] = S[Nint];
-    for (int i = 0; i <= Nint; ++i)
+    int firstBar = std::max (from - 1, 0);
+    int lastBar = std::min (to + 1, Nint);
+    for (int i = firstBar; i <= lastBar; ++i)
+    {
+        if (i == 0)
+            SBar[i] = S[0];
+        else if (i == Nint)
+            SBar[i] = S[Nint];
+        else
+            SBar[i] = (SHalf[i-1] + SHalf[i]) * 0.5;
         oOSBar[i] = 1.0 / SBar[i];
-    
-    return addPointsAt;
+    }
 }
 
 void Tube::calculateRadii()
 {
     radii.resize (Nint, 0);
-    for (int i = 0; i < Nint; ++i)
+    calculateRadii (0, Nint - 1);
+}
+
+void Tube::calculateRadii (int from, int to)
+{
+    for (int i = from; i <= std::min (to, Nint - 1); ++i)
         radii[i] = sqrt (S[i]) / double_Pi;
+}
+
+bool Tube::setAreas (double position, double length, const double* areas, int numAreas, bool fromBell)
+{
+    if (areas == nullptr || numAreas < 1 || numAreas > static_cast<int> (pendingAreas.size())
+        || !(position >= 0) || !(length >= 0) || ceil (position / h) > floor ((position + length) / h)
+        || ceil (position / h) > Nint)
+        return false;
+    
+    for (int i = 0; i < numAreas; ++i)
+        if (!(areas[i] > 0) || !std::isfinite (areas[i]))
+            return false;
+    
+    std::copy (areas, areas + numAreas, pendingAreas.begin());
+    pendingPosition = position;
+    pendingLength = length;
+    pendingFromBell = fromBell;
+    numPendingAreas = numAreas;
+    areasApplied = 0;
+    return true;
+}
+
+bool Tube::updateAreas()
+{
+    if (numPendingAreas == 0)
+        return false;
+    
+    // grid points (counted from the end the range is measured from) in the range, with the current h and Nint.
+    // The part from the bell stays at the bell when the slide adds or removes points at the junction.
+    int first = static_cast<int> (ceil (pendingPosition / h));
+    int last = std::min (static_cast<int> (floor ((pendingPosition + pendingLength) / h)), Nint);
+    int from = first + areasApplied;
+    int to = std::min (from + std::max (maxAreasPerUpdate, 1) - 1, last);
+    
+    // the rest of the range has moved out of the tube
+    if (from > to)
+    {
+        numPendingAreas = 0;
+        return false;
+    }
     
+    for (int j = from; j <= to; ++j)
+    {
+        double area = pendingAreas[0];
+        if (numPendingAreas > 1 && pendingLength > 0)
+        {
+            double idx = Global::limit ((j * h - pendingPosition) / pendingLength, 0.0, 1.0) * (numPendingAreas - 1);
+            int i = std::min (static_cast<int> (idx), numPendingAreas - 2);
+            area = pendingAreas[i] + (idx - i) * (pendingAreas[i+1] - pendingAreas[i]);
+        }
+        S[pendingFromBell ? Nint - j : j] = area;
+    }
+    areasApplied += to - from + 1;
+    if (first + areasApplied > last)
+        numPendingAreas = 0;
+    
+    int lo = pendingFromBell ? Nint - to : from;
+    int hi = pendingFromBell ? Nint - from : to;
+    calculateAreas (lo, hi);
+    calculateRadii (lo, hi);
+    if (hi == Nint)
+        calculateRadiationCoefficients();
+    
+    return lo <= 1;
 }
 double Tube::getKinEnergy()
 {
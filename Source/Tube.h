@@ -12,27 +12,70 @@
 
 #include <JuceHeader.h>
 #include "Global.h"
+#include "TromboneParameters.h"
+#include "JunctionInterpolator.h"
+#include "TubeScheme.h"
 
 //==============================================================================
 /*
 */
-class Tube  : public juce::Component
+class Tube
 {
 public:
-    Tube (NamedValueSet& parameters, double k, std::vector<std::vector<double>>& geometry);
-    ~Tube() override;
-
-    Path drawGeometry (Graphics& g, int topOrBottom);
-    Path visualiseState (Graphics& g, double visualScaling);
-    void paint (juce::Graphics&) override;
-    void resized() override;
+    Tube (const TromboneParameters& parameters, double k);
+    ~Tube();
 
     void calculateThermodynamicConstants();
-    int calculateGeometry (std::vector<std::vector<double>>& geometry, NamedValueSet& parameters);
+    void calculateRadiationCoefficients();
+    static double calculateSpeedOfSound (double T) { return 3.4723e2 * (1 + 0.00166 * (T - 26.85)); };
+    static double calculateDensity (double T) { return 1.1769 * (1 - 0.00335 * (T - 26.85)); };
+    
+    // radiation circuit at the bell (area SEnd): Lr parallel to R1 in series with R2 || Cr (also used by InputImpedance)
+    static void calculateRadiationCircuit (double SEnd, double rho, double c, double& R1, double& R2, double& Lr, double& Cr);
+    
+    // and its discretisation at time step k: p1Next = z1 * (p_bell^{n+1} + p_bell^n) / 2 + z2 * p1, z3 and z4 enter the
+    // update of the bell end (shared by all schemes with this boundary)
+    static void calculateRadiationCircuit (double SEnd, double rho, double c, double k, double& R1, double& R2, double& Lr, double& Cr,
+                                           double& z1, double& z2, double& z3, double& z4);
+    int calculateGeometry (const TromboneParameters& parameters);
+    void calculateAreas();
     void calculateRadii();
     void calculateVelocity();
     void calculatePressure();
     void calculateRadiation();
+    
+    // the convective term v * dv/dx of the momentum equation (wave steepening at high amplitudes), off by default.
+    // Explicit in v, with a limited upwind flux (see calculateVelocityNonlinear()). It needs the margin below the CFL
+    // limit of a tube constructed with TromboneParameters::nonlinearThreshold > 0. The energy calculation doesn't include it.
+    void setNonlinear (bool shouldBeNonlinear) { nonlinear = shouldBeNonlinear; };
+    bool isNonlinear() { return nonlinear; };
+    
+    // slide: change the length of the tube at runtime (at most maxSlideSpeed m/s)
+    void setTargetL (double LIn) { targetL = Global::limit (LIn, LMin, LMax); };
+    double getTargetL() { return targetL; };
+    bool updateL(); // returns true if h, rho and c have changed
+    
+    // air temperature: changes c and rho (and thereby h and N) at runtime, at most maxTempChange degrees per second
+    static constexpr double TMax = 50.0;
+    void setTargetT (double TIn) { targetT = Global::limit (TIn, TMin, TMax); };
+    double getTargetT() { return targetT; };
+    double getT() { return T; };
+    double getL() { return L; };
+    double getLMax() { return LMax; };
+    static double calculateSlideLength (double freq, double c, double LnonExtended, double LMax);
+
+    // time-varying bore (hand in the bell, mutes): sets the areas [m^2] of the grid points between position and
+    // position + length [m] from the mouthpiece (or from the bell end) to numAreas equally spaced samples (areas[0] at
+    // position), linearly interpolated. Doesn't allocate, returns false if the range contains no grid point, an area
+    // isn't positive or there are more than NintMax + 1 samples. Replaces the part of a previous change that
+    // hasn't been applied yet.
+    bool setAreas (double position, double length, const double* areas, int numAreas, bool fromBell = false);
+    bool hasPendingAreas() { return numPendingAreas > 0; };
+
+    // applies at most maxAreasPerUpdate grid points of the pending change (and recalculates only their neighbourhood),
+    // returns true if the areas at the lip (SBar[0] or SHalf[0]) have changed
+    bool updateAreas();
+    int maxAreasPerUpdate = 8;
 
     void setFlowVelocities (double UbIn, double UrIn)
     {
@@ -78,21 +121,61 @@ public:
     double getKinEnergy1() { return kinEnergy1; };
     double getPotEnergy1() { return potEnergy1; };
     double getRadEnergy1() { return radEnergy1; };
+    
+    // false if any of the newly calculated pressures is NaN, inf or larger than threshold (in magnitude)
+    bool isStable (double threshold);
+    void resetStates();
+    
+    // number of subnormal values in the states (see Denormals.h)
+    int countSubnormals();
+    
+    // state snapshots (see TromboneState), readState returns nullptr if the state doesn't fit this tube.
+    // With keepGeometry the areas of the state are skipped (the grid needs to be the same), to warm start another bore.
+    int getStateSize() { return getStateSize (Nint, M, Mw); };
+    static int getStateSize (int Nint, int M, int Mw) { return 4 * (M + Mw) + 4 + Nint + 1 + 23; };
+    int getMaxStateSize() { return getStateSize (NintMax, NintMax - Mw, Mw); }; // with the slide fully extended at the lowest temperature
+    double* writeState (double* dest);
+    const double* readState (const double* src, const double* end, bool keepGeometry = false);
 
 private:
+    template <int> friend class TromboneSection;
+    template <int, int> friend class FixedGridTrombone;
+    friend class TubeComponent;
+    friend class Pickups;
+    
+    void addPoint();
+    void removePoint();
+
+    // SHalf, SBar and oOSBar (radii) of the points that depend on S[from] to S[to]
+    void calculateAreas (int from, int to);
+    void calculateRadii (int from, int to);
+    
+    // one system (left or right of the junction) with the convective term, vLeft and vRight are the neighbours of the ends
+    void calculateVelocityNonlinear (double* vNext, const double* v, const double* p, int num, double vLeft, double vRight);
+    
     double k, h, c, lambda, rho, L, T;
+    double lambdaGrid; // the Courant number h is chosen for (lambda is the same up to rounding)
+    double targetL, LMin, LMax;
+    double maxSlideSpeed = 5.0;
+    double targetT, TMin;
+    double maxTempChange = 10.0;
+    int NintMax;
     int Nint, M, Mw;
     int NnonExtended;
     float N;
     
     // Radiation vars
-    double R1, rL, Lr, R2, Cr, z1, z2, z3, z4;
+    double R1, Lr, R2, Cr, z1, z2, z3, z4;
     double p1Next, p1, v1Next, v1;
     double oORadTerm;
     
     double Ub, Ur;
     
     double lambdaOverRhoC;
+    
+    bool nonlinear = false;
+    std::vector<double> nonlinearFlux, nonlinearSlopes;
+    
     std::vector<std::vector<double>> uvVecs;
     std::vector<std::vector<double>> upVecs;
     
@@ -100,7 +183,13 @@ private:
     std::vector<std::vector<double>> wpVecs;
 
     
+    // upMP1 and wpm1 are only kept for the layout of the state (TubeScheme::calculateJunction() doesn't store them)
     double upMP1, wpm1, uvNextMPh, uvMPh, wvNextmh, wvmh;
+    
+    // interpolation weights at the junction, only recalculated when alf changes
+    double ipOwn[JunctionInterpolator::numOwn];
+    double ipOther[JunctionInterpolator::numOther];
+    double ipAlf = -1;
 
     // pointers to states
     std::vector<double*> uv;
@@ -115,6 +204,13 @@ private:
 
     // tube geometry
     std::vector<double> S, SHalf, SBar, oOSBar, radii;
+
+    // change of the areas that hasn't been applied yet (see setAreas()), areasApplied grid points are done
+    std::vector<double> pendingAreas;
+    double pendingPosition = 0, pendingLength = 0;
+    int numPendingAreas = 0;
+    int areasApplied = 0;
+    bool pendingFromBell = false;
     
     double* uvTmp = nullptr;
     double* upTmp = nullptr;
@@ -126,7 +222,6 @@ private:
     double radEnergy1 = -1;
 
     bool raisedCos = false;
-    bool init = true;
     
     double qHRadPrev = 0;
 
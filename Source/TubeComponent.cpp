@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    TubeComponent.cpp
+    Created: 19 Oct 2026 8:14:27pm
+    Author:  Silvin Willemsen
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TubeComponent.h"
+
+//==============================================================================
+TubeComponent::TubeComponent (Tube& tube) : tube (tube)
+{
+}
+
+TubeComponent::~TubeComponent()
+{
+}
+
+void TubeComponent::paint (juce::Graphics& g)
+{
+    /* This demo code just fills the component's background and
+       draws some placeholder text to get you started.
+
+       You should replace everything in this method with your own
+       drawing code..
+    */
+
+//    if (init)
+//    {
+        g.setColour (Colours::gold);
+        Path stringPathTop = drawGeometry (g, -1);
+        Path stringPathBottom = drawGeometry (g, 1);
+        g.strokePath (stringPathTop, PathStrokeType(2.0f));
+        g.strokePath (stringPathBottom, PathStrokeType(2.0f));
+//    }
+    g.setColour (Colours::cyan);
+    Path state = visualiseState (g, (Global::setTubeTo1 ? 10000 : 0.01) * Global::oOPressureMultiplier);
+    g.strokePath (state, PathStrokeType (2.0f));
+
+    
+//    std::cout << "repainted" << std::endl;
+
+}
+
+Path TubeComponent::drawGeometry (Graphics& g, int topOrBottom)
+{
+    double visualScaling = 1000.0;
+    Path stringPath;
+    stringPath.startNewSubPath (0, topOrBottom * tube.radii[0] * visualScaling + getHeight() * 0.5);
+    int stateWidth = getWidth();
+    auto spacing = stateWidth / static_cast<double>(tube.Nint - 1);
+    auto x = spacing;
+    
+    for (int y = 1; y < tube.Nint; y++)
+    {
+        stringPath.lineTo(x, topOrBottom * tube.radii[y] * visualScaling + getHeight() * 0.5);
+        x += spacing;
+    }
+    return stringPath;
+}
+
+Path TubeComponent::visualiseState (Graphics& g, double visualScaling)
+{
+    auto stringBounds = getHeight() / 2.0;
+    Path stringPath;
+    stringPath.startNewSubPath (0, -tube.up[1][0] * visualScaling + stringBounds);
+    int stateWidth = getWidth();
+    auto spacing = stateWidth / static_cast<double>(tube.Nint - 1);
+    auto x = spacing;
+    bool switchToW = false;
+    
+    for (int y = 1; y <= tube.Nint + 1; y++)
+    {
+        float newY;
+        if (y <= tube.M)
+        {
+            newY = -tube.up[1][y] * visualScaling + stringBounds; // Needs to be -p, because a positive p would visually go down
+//            if (y == tube.M-1)
+//            {
+//                std::cout << x;
+//            }
+            if (isnan(x) || isinf(abs(x) || isnan(tube.up[1][y]) || isinf(abs(tube.up[1][y]))))
+                DIAGNOSTIC_WARNING ("invalid state in visualisation (u)", y);
+            
+        } else {
+            if (!switchToW)
+            {
+                x -= spacing;
+                switchToW = true;
+            }
+            newY = -tube.wp[1][y-tube.M] * visualScaling + stringBounds; // Needs to be -p, because a positive p would visually go down
+//            if (y == tube.M)
+//            {
+//                std::cout << ", " << x << std::endl;;
+//            }
+            if (isnan(x) || isinf(abs(x) || isnan(tube.wp[1][y-tube.M]) || isinf(abs(tube.wp[1][y-tube.M]))))
+                DIAGNOSTIC_WARNING ("invalid state in visualisation (w)", y - tube.M);
+
+        }
+       
+        
+        if (isnan(newY))
+            newY = 0;
+        stringPath.lineTo (x, newY);
+        //        g.drawEllipse(x, newY, 2, 2, 5);
+        x += spacing;
+    }
+    return stringPath;
+}
+
+void TubeComponent::resized()
+{
+    // This method is where you should set the bounds of any child
+    // components that your component contains..
+
+}
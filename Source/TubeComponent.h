@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    TubeComponent.h
+    Created: 19 Oct 2026 8:14:27pm
+    Author:  Silvin Willemsen
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Tube.h"
+
+//==============================================================================
+/*
+    Draws the geometry and the pressure along a Tube.
+*/
+class TubeComponent  : public juce::Component
+{
+public:
+    TubeComponent (Tube& tube);
+    ~TubeComponent() override;
+
+    Path drawGeometry (Graphics& g, int topOrBottom);
+    Path visualiseState (Graphics& g, double visualScaling);
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+    Tube& tube;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TubeComponent)
+};
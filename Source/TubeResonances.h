@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    TubeResonances.h
+    Created: 19 Oct 2026 3:41:07pm
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Frequencies of the first numResonances peaks of the pressure response of a
+    tube (Tube, HybridTube or ImplicitTube) to a flow impulse, to compare the
+    tuning of the engines (--benchmark-hybrid and --benchmark-implicit).
+*/
+template <typename TubeType>
+std::vector<double> measureResonances (TubeType& tube, double k, int numResonances)
+{
+    // one second of the mouth pressure after a flow impulse (the resonances have decayed by then)
+    int numSamples = static_cast<int> (1.0 / k);
+    std::vector<double> p (numSamples);
+    tube.resetStates();
+    for (int n = 0; n < numSamples; ++n)
+    {
+        tube.calculateVelocity();
+        tube.setFlowVelocities (n == 0 ? 1e-3 : 0, 0);
+        tube.calculatePressure();
+        tube.calculateRadiation();
+        p[n] = tube.getP (0, 0);
+        tube.updateStates();
+    }
+
+    // |P(f)|^2, the rotation is applied recursively
+    auto power = [&] (double f) {
+        double cs = cos (2.0 * double_Pi * f * k);
+        double sn = sin (2.0 * double_Pi * f * k);
+        double re = 1, im = 0, sumRe = 0, sumIm = 0;
+        for (int n = 0; n < numSamples; ++n)
+        {
+            sumRe += p[n] * re;
+            sumIm -= p[n] * im;
+            double tmp = re * cs - im * sn;
+            im = re * sn + im * cs;
+            re = tmp;
+        }
+        return sumRe * sumRe + sumIm * sumIm;
+    };
+
+    // peaks on a 1 Hz grid, refined by a golden section search
+    std::vector<double> resonances;
+    double prevPrev = 0, prev = power (20.0);
+    for (double f = 21.0; f < 0.5 / k && static_cast<int> (resonances.size()) < numResonances; f += 1.0)
+    {
+        double cur = power (f);
+        if (prev > cur && prev > prevPrev)
+        {
+            double a = f - 2.0, b = f;
+            for (int i = 0; i < 40; ++i)
+            {
+                double m1 = a + 0.382 * (b - a);
+                double m2 = a + 0.618 * (b - a);
+                if (power (m1) > power (m2))
+                    b = m2;
+                else
+                    a = m1;
+            }
+            resonances.push_back (0.5 * (a + b));
+        }
+        prevPrev = prev;
+        prev = cur;
+    }
+    return resonances;
+}
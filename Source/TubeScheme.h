@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    TubeScheme.h
+    Created: 23 Oct 2026 10:14:52am
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Global.h"
+#include "JunctionInterpolator.h"
+
+//==============================================================================
+/*
+    The update equations of the (linear) tube, shared by Tube, FixedGridTrombone
+    and TromboneSection so that they can't drift apart.
+
+    The states of stride tubes on the same grid can be interleaved per grid
+    point ([l * stride + lane]), then every loop runs over all of them (see
+    TromboneSection). The per-tube values at the junction and the radiation
+    (uvMPh, v1, ...) are arrays of stride values. The sizes are arguments, so
+    the callers with a compile-time grid (FixedGridTrombone) get constant trip
+    counts once these are inlined.
+
+    The expressions (and their order of evaluation) are those of the original
+    Tube, so all users produce bit-identical outputs.
+*/
+struct TubeScheme
+{
+    // v^{n+1} of one system: num velocities between num + 1 pressures
+    template <int stride = 1>
+    static void calculateVelocity (double* vNext, const double* v, const double* p, int num, double lambdaOverRhoC)
+    {
+        for (int i = 0; i < num * stride; ++i)
+            vNext[i] = v[i] - lambdaOverRhoC * (p[i + stride] - p[i]);
+    }
+
+    // the virtual points u_{M+1} and w_{-1} (see JunctionInterpolator) and the velocities next to them,
+    // summed from left to right (as the original quadratic interpolation)
+    template <int stride = 1>
+    static void calculateJunction (const double* up, const double* wp, int M, const double* ipOwn, const double* ipOther, double lambdaOverRhoC,
+                                   const double* uvMPh, const double* wvmh, double* uvNextMPh, double* wvNextmh)
+    {
+        for (int lane = 0; lane < stride; ++lane)
+        {
+            double upMP1 = 0;
+            double wpm1 = 0;
+            for (int j = JunctionInterpolator::numOwn - 1; j >= 0; --j)
+                upMP1 += ipOwn[j] * up[(M - j) * stride + lane];
+            for (int j = 0; j < JunctionInterpolator::numOther; ++j)
+                upMP1 += ipOther[j] * wp[j * stride + lane];
+            for (int j = JunctionInterpolator::numOther - 1; j >= 0; --j)
+                wpm1 += ipOther[j] * up[(M - j) * stride + lane];
+            for (int j = 0; j < JunctionInterpolator::numOwn; ++j)
+                wpm1 += ipOwn[j] * wp[j * stride + lane];
+
+            uvNextMPh[lane] = uvMPh[lane] - lambdaOverRhoC * (upMP1 - up[M * stride + lane]);
+            wvNextmh[lane] = wvmh[lane] - lambdaOverRhoC * (wp[lane] - wpm1);
+        }
+    }
+
+    // p^{n+1} at grid points from to to - 1 of one system, v[l] is the velocity right of point l (oOSBar and SHalf of the system)
+    template <int stride = 1>
+    static void calculatePressure (double* pNext, const double* p, const double* v, int from, int to,
+                                   double rhoCLambda, const double* oOSBar, const double* SHalf)
+    {
+        for (int l = from; l < to; ++l)
+        {
+            double coeff = rhoCLambda * oOSBar[l];
+            double SHalfL = SHalf[l];
+            double SHalfLm1 = SHalf[l-1];
+            for (int lane = 0; lane < stride; ++lane)
+            {
+                int i = l * stride + lane;
+                pNext[i] = p[i] - coeff * (SHalfL * v[i] - SHalfLm1 * v[i - stride]);
+            }
+        }
+    }
+
+    // the inner boundaries: with the velocity on the other side of the junction
+    static double calculateBoundaryPressure (double p, double rhoCLambda, double oOSBar, double SHalfRight, double vRight, double SHalfLeft, double vLeft)
+    {
+        return p - rhoCLambda * oOSBar * (SHalfRight * vRight - SHalfLeft * vLeft);
+    }
+
+    // the mouthpiece: driven by the flow U = Ub + Ur of the lips
+    static double calculateExcitation (double p, double rhoCLambda, double oOSBar0, double U, double SHalf0, double v0)
+    {
+        return p - rhoCLambda * oOSBar0 * (-2.0 * U + 2.0 * SHalf0 * v0);
+    }
+
+    // the bell end (see Tube::calculateRadiationCircuit()), vLast is the last velocity of the right system
+    template <int stride = 1>
+    static void calculateRadiation (double* pNext, const double* p, const double* vLast, const double* v1, const double* p1, double* v1Next, double* p1Next,
+                                    double rhoCLambda, double SHalfLast, double oOSBarNint, double z1, double z2, double z3, double z4,
+                                    double oORadTerm, double kOver2Lr)
+    {
+        for (int lane = 0; lane < stride; ++lane)
+        {
+            pNext[lane] = ((1.0 - rhoCLambda * z3) * p[lane] - 2.0 * rhoCLambda * (v1[lane] + z4 * p1[lane] - (SHalfLast * vLast[lane]) * oOSBarNint)) * oORadTerm;
+
+            v1Next[lane] = v1[lane] + kOver2Lr * (pNext[lane] + p[lane]);
+            p1Next[lane] = z1 * 0.5 * (pNext[lane] + p[lane]) + z2 * p1[lane];
+        }
+    }
+};